@@ -0,0 +1,1595 @@
+/*
+  ==============================================================================
+
+    Headless benchmark for Project13AudioProcessor::processBlock.
+
+    Runs the processor, every module audible, over synthetic noise for every
+    combination of sample rate, block size, DSP_Order permutation and channel
+    count and prints the results as JSON so CPU cost can be tracked across releases.
+
+    --golden <dir> runs the golden-render suite instead: fixed renders
+    checked for sound, and with --check-budgets for CPU cost, see runGoldenSuite().
+
+    The GoldenTest configuration (PROJECT13_GOLDEN_TEST=1) only runs the
+    golden-render suite, against Benchmark/Golden unless --golden says otherwise.
+
+    The RealtimeCheck configuration (PROJECT13_RT_CHECK=1) times nothing:
+    it runs the processor through every switch it has and fails on anything
+    that could block the audio thread, see runRealtimeExercise().
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <optional>
+
+#ifndef PROJECT13_GOLDEN_TEST
+ #define PROJECT13_GOLDEN_TEST 0
+#endif
+
+using DSP_Option = Project13AudioProcessor::DSP_Option;
+using DSP_Order = Project13AudioProcessor::DSP_Order;
+
+auto getSampleRates() { return std::vector<double> { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 }; }
+auto getBlockSizes() { return std::vector<int> { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 }; }
+
+juce::String getDSPOptionName(DSP_Option option)
+{
+    switch (option)
+    {
+        case DSP_Option::Phase:
+            return "Phase";
+        case DSP_Option::Chorus:
+            return "Chorus";
+        case DSP_Option::OverDrive:
+            return "OverDrive";
+        case DSP_Option::LadderFilter:
+            return "LadderFilter";
+        case DSP_Option::GeneralFilter:
+            return "GeneralFilter";
+        case DSP_Option::Delay:
+            return "Delay";
+        case DSP_Option::END_OF_LIST:
+            break;
+    }
+
+    return "END_OF_LIST";
+}
+
+/*
+ every ordering of the DSP_Options, in lexicographic order.
+ */
+std::vector<DSP_Order> getAllDSPOrders()
+{
+    DSP_Order order;
+    for( size_t i = 0; i < order.size(); ++i )
+        order[i] = static_cast<DSP_Option>(i);
+
+    std::vector<DSP_Order> orders;
+    do
+    {
+        orders.push_back(order);
+    }
+    while( std::next_permutation(order.begin(), order.end()) );
+
+    return orders;
+}
+
+struct BenchmarkSettings
+{
+    double secondsPerRun = 0.5;
+    int warmupBlocks = 16;
+    bool allOrders = true;
+    //which chain dispatch to measure. both by default, so the report shows the difference.
+    std::vector<bool> staticDispatch { true, false };
+    //stereo by default. mono runs the mono specialisations of the chain.
+    std::vector<int> channelCounts { 2 };
+    //the processor's internal sub-block size. 32 and 64 are the interesting ones.
+    int subBlockSize = Project13AudioProcessor::defaultSubBlockSize;
+    juce::File outputFile;
+    //set: only record a per-module trace under automation, see writeTrace().
+    juce::File traceFile;
+    //set: only run the golden-render suite against this directory, see runGoldenSuite().
+    juce::File goldenDirectory;
+    //record the golden renders and CPU budgets instead of checking against them.
+    bool updateGolden = false;
+    //the largest difference from a golden render that still passes. -80dB.
+    float goldenTolerance = 1.0e-4f;
+    //check each render's CPU cost against its budget. off by default: see runGoldenSuite().
+    bool checkBudgets = false;
+    //recorded budgets are the measured CPU cost times this.
+    double budgetHeadroom = 1.5;
+    //each configuration's CPU load is the fastest of this many renders.
+    int budgetRuns = 5;
+};
+
+BenchmarkSettings parseArgs(const juce::StringArray& args)
+{
+    BenchmarkSettings settings;
+
+    for( int i = 0; i < args.size(); ++i )
+    {
+        auto& arg = args[i];
+
+        if( arg == "--seconds" && i + 1 < args.size() )
+            settings.secondsPerRun = juce::jmax(0.01, args[++i].getDoubleValue());
+        else if( arg == "--warmup" && i + 1 < args.size() )
+            settings.warmupBlocks = juce::jmax(0, args[++i].getIntValue());
+        else if( arg == "--single-order" )
+            settings.allOrders = false;
+        else if( arg == "--dispatch" && i + 1 < args.size() )
+        {
+            auto dispatch = args[++i];
+            if( dispatch == "static" )
+                settings.staticDispatch = { true };
+            else if( dispatch == "virtual" )
+                settings.staticDispatch = { false };
+            else
+                settings.staticDispatch = { true, false };
+        }
+        else if( arg == "--channels" && i + 1 < args.size() )
+        {
+            auto channels = args[++i];
+            if( channels == "mono" )
+                settings.channelCounts = { 1 };
+            else if( channels == "both" )
+                settings.channelCounts = { 1, 2 };
+            else
+                settings.channelCounts = { 2 };
+        }
+        else if( arg == "--sub-block" && i + 1 < args.size() )
+            settings.subBlockSize = juce::jlimit(1, 4096, args[++i].getIntValue());
+        else if( arg == "--output" && i + 1 < args.size() )
+            settings.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+        else if( arg == "--trace" && i + 1 < args.size() )
+            settings.traceFile = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+        else if( arg == "--golden" && i + 1 < args.size() )
+            settings.goldenDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+        else if( arg == "--update-golden" )
+            settings.updateGolden = true;
+        else if( arg == "--tolerance" && i + 1 < args.size() )
+            settings.goldenTolerance = juce::jmax(0.f, args[++i].getFloatValue());
+        else if( arg == "--check-budgets" )
+            settings.checkBudgets = true;
+        else if( arg == "--budget-headroom" && i + 1 < args.size() )
+            settings.budgetHeadroom = juce::jmax(1.0, args[++i].getDoubleValue());
+        else if( arg == "--budget-runs" && i + 1 < args.size() )
+            settings.budgetRuns = juce::jmax(1, args[++i].getIntValue());
+    }
+
+    return settings;
+}
+
+/*
+ Pre-generated noise so the RNG isn't inside the timed region.
+ Fixed seed so every run processes identical input.
+ */
+juce::AudioBuffer<float> makeNoise(int numChannels, int numSamples)
+{
+    juce::AudioBuffer<float> noise(numChannels, numSamples);
+    juce::Random random(0x13);
+
+    for( int ch = 0; ch < numChannels; ++ch )
+    {
+        auto* data = noise.getWritePointer(ch);
+        for( int i = 0; i < numSamples; ++i )
+            data[i] = random.nextFloat() * 0.5f - 0.25f;
+    }
+
+    return noise;
+}
+
+/*
+ settings that make the module audible. at the defaults most of them are neutral and skip their DSP.
+ */
+std::vector<std::pair<juce::String, float>> getAudibleSettings(DSP_Option option)
+{
+    switch (option)
+    {
+        case DSP_Option::Phase:
+            return { { "Phaser RateHz", 0.5f }, { "Phaser Depth %", 0.8f }, { "Phaser Center FreqHz", 1000.f }, { "Phaser Feedback %", 0.7f }, { "Phaser Mix %", 1.f } };
+        case DSP_Option::Chorus:
+            return { { "Chorus RateHz", 1.f }, { "Chorus Depth %", 0.5f }, { "Chorus Center Delay ms", 10.f }, { "Chorus Feedback %", 0.3f }, { "Chorus Mix %", 0.5f } };
+        case DSP_Option::OverDrive:
+            return { { "OverDrive Saturation", 10.f }, { "OverDrive Mix %", 1.f } };
+        case DSP_Option::LadderFilter:
+            return { { "Ladder Filter Cutoff Hz", 1000.f }, { "Ladder Filter Resonance", 0.7f }, { "Ladder Filter Drive", 2.f }, { "Ladder Filter Mix %", 1.f } };
+        case DSP_Option::GeneralFilter:
+            return { { "General Filter Freq hz", 1000.f }, { "General Filter Quality", 2.f }, { "General Filter Gain", 6.f }, { "General Filter Mix %", 1.f } };
+        case DSP_Option::Delay:
+            return { { "Delay Time ms", 120.f }, { "Delay Feedback %", 0.5f }, { "Delay Mix %", 0.5f } };
+        case DSP_Option::END_OF_LIST:
+            break;
+    }
+
+    return {};
+}
+
+/*
+ every module's audible settings, so the chain runs all of its DSP rather than skipping
+ the modules that are neutral at their defaults.
+ */
+void applyAudibleSettings(Project13AudioProcessor& processor)
+{
+    for( size_t i = 0; i < static_cast<size_t>(DSP_Option::END_OF_LIST); ++i )
+    {
+        for( auto& [name, value] : getAudibleSettings(static_cast<DSP_Option>(i)) )
+        {
+            auto* parameter = processor.apvts.getParameter(name);
+            jassert(parameter != nullptr);
+            if( parameter != nullptr )
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+    }
+}
+
+double getPercentile(const std::vector<double>& sortedValues, double percentile)
+{
+    if( sortedValues.empty() )
+        return 0.0;
+
+    auto index = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(sortedValues.size())));
+    index = juce::jlimit<size_t>(1, sortedValues.size(), index);
+    return sortedValues[index - 1];
+}
+
+juce::var runProcessBlockBenchmark(double sampleRate,
+                                   int blockSize,
+                                   const DSP_Order& order,
+                                   bool staticDispatch,
+                                   int numChannels,
+                                   const juce::AudioBuffer<float>& noise,
+                                   const BenchmarkSettings& settings)
+{
+    Project13AudioProcessor processor;
+    processor.useStaticDispatch.store(staticDispatch);
+    processor.subBlockSize.store(settings.subBlockSize);
+    processor.setNonRealtime(false);
+    applyAudibleSettings(processor);
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    processor.dspOrderFifo.push(order);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    const auto numBlocks = juce::jmax(1, juce::roundToInt(settings.secondsPerRun * sampleRate / blockSize));
+    std::vector<double> blockTimesNs;
+    blockTimesNs.reserve(static_cast<size_t>(numBlocks));
+
+    int readPosition = 0;
+    auto fillFromNoise = [&]()
+    {
+        if( readPosition + blockSize > noise.getNumSamples() )
+            readPosition = 0;
+
+        for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+            buffer.copyFrom(ch, 0, noise, ch, readPosition, blockSize);
+
+        readPosition += blockSize;
+    };
+
+    for( int i = 0; i < settings.warmupBlocks; ++i )
+    {
+        fillFromNoise();
+        processor.processBlock(buffer, midi);
+    }
+
+    double totalNs = 0.0;
+    for( int i = 0; i < numBlocks; ++i )
+    {
+        fillFromNoise();
+
+        auto start = std::chrono::steady_clock::now();
+        processor.processBlock(buffer, midi);
+        auto end = std::chrono::steady_clock::now();
+
+        auto ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        blockTimesNs.push_back(ns);
+        totalNs += ns;
+    }
+
+    processor.releaseResources();
+
+    std::sort(blockTimesNs.begin(), blockTimesNs.end());
+
+    const auto numSamples = static_cast<double>(numBlocks) * blockSize;
+    const auto audioNs = numSamples / sampleRate * 1.0e9;
+
+    juce::Array<juce::var> orderNames;
+    for( auto option : order )
+        orderNames.add(getDSPOptionName(option));
+
+    juce::DynamicObject::Ptr percentiles = new juce::DynamicObject();
+    percentiles->setProperty("min", blockTimesNs.front());
+    percentiles->setProperty("p50", getPercentile(blockTimesNs, 50.0));
+    percentiles->setProperty("p90", getPercentile(blockTimesNs, 90.0));
+    percentiles->setProperty("p99", getPercentile(blockTimesNs, 99.0));
+    percentiles->setProperty("p999", getPercentile(blockTimesNs, 99.9));
+    percentiles->setProperty("max", blockTimesNs.back());
+
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("sampleRate", sampleRate);
+    result->setProperty("blockSize", blockSize);
+    result->setProperty("order", orderNames);
+    result->setProperty("dispatch", staticDispatch ? "static" : "virtual");
+    result->setProperty("channels", numChannels);
+    result->setProperty("subBlockSize", settings.subBlockSize);
+    result->setProperty("numBlocks", numBlocks);
+    result->setProperty("nsPerSample", totalNs / numSamples);
+    //how many times faster than real time the chain runs. > 1 means it keeps up.
+    result->setProperty("realTimeFactor", totalNs > 0.0 ? audioNs / totalNs : 0.0);
+    result->setProperty("blockTimeNs", percentiles.get());
+
+    return result.get();
+}
+
+/*
+ ns/sample of the ladder-filter-based overdrive the OverDrive slot used to run,
+ against each Waveshaper curve, at the same drive.
+ */
+juce::var runOverdriveBenchmark(double sampleRate,
+                                int blockSize,
+                                float drive,
+                                const juce::AudioBuffer<float>& noise,
+                                const BenchmarkSettings& settings)
+{
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(blockSize);
+    spec.numChannels = static_cast<juce::uint32>(noise.getNumChannels());
+
+    const auto numBlocks = juce::jmax(1, juce::roundToInt(settings.secondsPerRun * sampleRate / blockSize));
+    juce::AudioBuffer<float> buffer(noise.getNumChannels(), blockSize);
+
+    auto measureNsPerSample = [&](auto& dsp)
+    {
+        double totalNs = 0.0;
+        int readPosition = 0;
+
+        for( int i = 0; i < numBlocks + settings.warmupBlocks; ++i )
+        {
+            if( readPosition + blockSize > noise.getNumSamples() )
+                readPosition = 0;
+
+            for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+                buffer.copyFrom(ch, 0, noise, ch, readPosition, blockSize);
+
+            readPosition += blockSize;
+
+            auto block = juce::dsp::AudioBlock<float>(buffer);
+            auto context = juce::dsp::ProcessContextReplacing<float>(block);
+
+            auto start = std::chrono::steady_clock::now();
+            dsp.process(context);
+            auto end = std::chrono::steady_clock::now();
+
+            if( i >= settings.warmupBlocks )
+                totalNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+
+        return totalNs / (static_cast<double>(numBlocks) * blockSize);
+    };
+
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("sampleRate", sampleRate);
+    result->setProperty("blockSize", blockSize);
+    result->setProperty("drive", drive);
+
+    juce::dsp::LadderFilter<float> ladder;
+    ladder.prepare(spec);
+    ladder.setMode(juce::dsp::LadderFilterMode::LPF12);
+    ladder.setCutoffFrequencyHz(20000.f);
+    ladder.setDrive(drive);
+    result->setProperty("ladderNsPerSample", measureNsPerSample(ladder));
+
+    auto curveNames = std::array { "tanh", "softClip", "asymmetricTube", "hardClip" };
+    for( size_t i = 0; i < curveNames.size(); ++i )
+    {
+        Waveshaper shaper;
+        shaper.prepare(spec);
+        shaper.setCurve(static_cast<WaveshaperCurve>(i));
+        shaper.setDrive(drive);
+        shaper.reset();
+        result->setProperty(juce::String(curveNames[i]) + "NsPerSample", measureNsPerSample(shaper));
+    }
+
+    return result.get();
+}
+
+/*
+ ns/sample of processBlock with a CC mapped to the ladder filter cutoff arriving every
+ ccInterval samples (0: no CCs). dense streams are coalesced, so the cost should level
+ off instead of growing with the CC rate.
+ */
+juce::var runMidiCCBenchmark(double sampleRate,
+                             int blockSize,
+                             int ccInterval,
+                             const juce::AudioBuffer<float>& noise,
+                             const BenchmarkSettings& settings)
+{
+    constexpr int controller = 74;
+
+    Project13AudioProcessor processor;
+    processor.subBlockSize.store(settings.subBlockSize);
+    processor.setNonRealtime(false);
+    applyAudibleSettings(processor);
+    processor.setPlayConfigDetails(noise.getNumChannels(), noise.getNumChannels(), sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    if( auto* cutoff = processor.apvts.getParameter("Ladder Filter Cutoff Hz") )
+        processor.midiLearn.setMapping(controller, cutoff->getParameterIndex());
+
+    juce::AudioBuffer<float> buffer(noise.getNumChannels(), blockSize);
+    juce::MidiBuffer midi;
+    int ccValue = 0;
+
+    const auto numBlocks = juce::jmax(1, juce::roundToInt(settings.secondsPerRun * sampleRate / blockSize));
+    double totalNs = 0.0;
+    int readPosition = 0;
+
+    for( int i = 0; i < numBlocks + settings.warmupBlocks; ++i )
+    {
+        if( readPosition + blockSize > noise.getNumSamples() )
+            readPosition = 0;
+
+        for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+            buffer.copyFrom(ch, 0, noise, ch, readPosition, blockSize);
+
+        readPosition += blockSize;
+
+        //a sweep up and down, built outside the timed region.
+        midi.clear();
+        for( int position = 0; ccInterval > 0 && position < blockSize; position += ccInterval )
+        {
+            midi.addEvent(juce::MidiMessage::controllerEvent(1, controller, std::abs(ccValue % 254 - 127)), position);
+            ++ccValue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        processor.processBlock(buffer, midi);
+        auto end = std::chrono::steady_clock::now();
+
+        if( i >= settings.warmupBlocks )
+            totalNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    processor.releaseResources();
+
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("sampleRate", sampleRate);
+    result->setProperty("blockSize", blockSize);
+    result->setProperty("ccInterval", ccInterval);
+    result->setProperty("nsPerSample", totalNs / (static_cast<double>(numBlocks) * blockSize));
+
+    return result.get();
+}
+
+/*
+ Two seconds of processBlock at 48k / 256 samples under automation, recorded by the stage
+ profiler and written as Chrome trace-event JSON (chrome://tracing, Perfetto):
+    every processBlock call and every module call as a complete event
+    each module's total per block as a counter, so the cost shows block by block
+    the automation as instant events
+ The automation: a CC sweeping the ladder cutoff all the way through, the overdrive's
+ oversampling going up at 1/4 and an order change at 1/2.
+ */
+bool writeTrace(const juce::File& file, const juce::AudioBuffer<float>& noise, const BenchmarkSettings& settings)
+{
+    using Profiler = Project13AudioProcessor::Profiler;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int controller = 74;
+    constexpr int numStages = static_cast<int>(DSP_Option::END_OF_LIST);
+
+    Project13AudioProcessor processor;
+    processor.subBlockSize.store(settings.subBlockSize);
+    processor.setNonRealtime(false);
+    applyAudibleSettings(processor);
+    processor.setPlayConfigDetails(noise.getNumChannels(), noise.getNumChannels(), sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    if( auto* cutoff = processor.apvts.getParameter("Ladder Filter Cutoff Hz") )
+        processor.midiLearn.setMapping(controller, cutoff->getParameterIndex());
+
+    const auto numBlocks = juce::roundToInt(2.0 * sampleRate / blockSize);
+
+    //a block, and every stage once per sub-block.
+    const auto subBlocksPerBlock = blockSize / settings.subBlockSize + 2;
+    processor.stageProfiler.startTrace(static_cast<size_t>(numBlocks * (1 + numStages * subBlocksPerBlock)));
+
+    juce::AudioBuffer<float> buffer(noise.getNumChannels(), blockSize);
+    juce::MidiBuffer midi;
+    int readPosition = 0;
+
+    struct Marker
+    {
+        juce::String name;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    std::vector<Marker> markers;
+
+    for( int i = 0; i < numBlocks; ++i )
+    {
+        if( readPosition + blockSize > noise.getNumSamples() )
+            readPosition = 0;
+
+        for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+            buffer.copyFrom(ch, 0, noise, ch, readPosition, blockSize);
+
+        readPosition += blockSize;
+
+        midi.clear();
+        midi.addEvent(juce::MidiMessage::controllerEvent(1, controller, 127 * i / numBlocks), 0);
+
+        if( i == numBlocks / 4 )
+        {
+            if( auto* oversampling = processor.apvts.getParameter("OverDrive Oversampling") )
+                oversampling->setValueNotifyingHost(1.f);
+
+            markers.push_back({ "OverDrive oversampling up", std::chrono::steady_clock::now() });
+        }
+
+        if( i == numBlocks / 2 )
+        {
+            processor.dspOrderFifo.push(DSP_Order {{ DSP_Option::Delay, DSP_Option::GeneralFilter, DSP_Option::LadderFilter, DSP_Option::OverDrive, DSP_Option::Chorus, DSP_Option::Phase }});
+            markers.push_back({ "order change", std::chrono::steady_clock::now() });
+        }
+
+        processor.processBlock(buffer, midi);
+    }
+
+    auto events = processor.stageProfiler.stopTrace();
+    processor.releaseResources();
+
+    if( events.empty() )
+        return false;
+
+    const auto origin = events.front().start;
+    auto toMicroseconds = [origin](std::chrono::steady_clock::time_point t)
+    {
+        return std::chrono::duration<double, std::micro>(t - origin).count();
+    };
+
+    auto getName = [](int stage)
+    {
+        return stage == Profiler::blockStage ? juce::String("processBlock")
+                                             : juce::String(Project13AudioProcessor::getModuleName(static_cast<DSP_Option>(stage)));
+    };
+
+    juce::Array<juce::var> traceEvents;
+    std::array<double, numStages> blockTotals {};
+
+    for( auto& event : events )
+    {
+        juce::DynamicObject::Ptr e = new juce::DynamicObject();
+        e->setProperty("name", getName(event.stage));
+        e->setProperty("cat", event.stage == Profiler::blockStage ? "block" : "module");
+        e->setProperty("ph", "X");
+        e->setProperty("ts", toMicroseconds(event.start));
+        e->setProperty("dur", toMicroseconds(event.end) - toMicroseconds(event.start));
+        e->setProperty("pid", 1);
+        e->setProperty("tid", 1);
+        traceEvents.add(e.get());
+
+        if( event.stage != Profiler::blockStage )
+        {
+            blockTotals[static_cast<size_t>(event.stage)] += toMicroseconds(event.end) - toMicroseconds(event.start);
+            continue;
+        }
+
+        //the block's event comes after its stages'.
+        juce::DynamicObject::Ptr totals = new juce::DynamicObject();
+        for( int stage = 0; stage < numStages; ++stage )
+            totals->setProperty(getName(stage), blockTotals[static_cast<size_t>(stage)]);
+
+        juce::DynamicObject::Ptr counter = new juce::DynamicObject();
+        counter->setProperty("name", "module us per block");
+        counter->setProperty("ph", "C");
+        counter->setProperty("ts", toMicroseconds(event.start));
+        counter->setProperty("pid", 1);
+        counter->setProperty("args", totals.get());
+        traceEvents.add(counter.get());
+
+        blockTotals = {};
+    }
+
+    for( auto& marker : markers )
+    {
+        juce::DynamicObject::Ptr e = new juce::DynamicObject();
+        e->setProperty("name", marker.name);
+        e->setProperty("ph", "i");
+        e->setProperty("s", "g");
+        e->setProperty("ts", toMicroseconds(marker.time));
+        e->setProperty("pid", 1);
+        e->setProperty("tid", 1);
+        traceEvents.add(e.get());
+    }
+
+    juce::DynamicObject::Ptr trace = new juce::DynamicObject();
+    trace->setProperty("traceEvents", traceEvents);
+    trace->setProperty("displayTimeUnit", "ns");
+
+    return file.replaceWithText(juce::JSON::toString(trace.get(), true));
+}
+
+//==============================================================================
+/*
+ Golden renders: fixed input through fixed configurations, compared against stored renders
+ so a change to the DSP can be checked for sound and speed at once.
+
+ every configuration renders the same second of stereo input at 48k / 256 samples:
+    two impulses, for the filters' and delays' responses
+    an exponential sine sweep, 20Hz - 20kHz, for the frequency response and aliasing
+    noise, for the modulated effects
+    silence, for the tails
+ --update-golden writes <configuration>.wav (32 bit float) and budgets.json into the
+ --golden directory. without it each render is checked against its .wav within --tolerance.
+
+ a render's CPU cost is its processBlock time over the time measureReferenceLoad() takes in
+ the same run, so budgets recorded on one machine roughly carry over to another: a faster
+ machine is faster at both. the recorded budgets are the costs with --budget-headroom.
+ how far the ratio moves between CPUs still depends on their vector units and caches, so
+ budgets are only checked with --check-budgets, on machines they've been found to hold on.
+ budgets.json is plain JSON, so budgets can be tightened or loosened by hand.
+ */
+struct GoldenConfig
+{
+    juce::String name;
+    DSP_Order order {{ DSP_Option::Phase, DSP_Option::Chorus, DSP_Option::OverDrive, DSP_Option::LadderFilter, DSP_Option::GeneralFilter, DSP_Option::Delay }};
+    //parameter name and value. everything else stays at its default.
+    std::vector<std::pair<juce::String, float>> parameters;
+    //swept linearly from sweepFrom to sweepTo over the render, a step per block. empty: nothing is swept.
+    juce::String sweptParameter;
+    float sweepFrom = 0.f, sweepTo = 0.f;
+};
+
+juce::String getBypassParameterName(DSP_Option option)
+{
+    switch (option)
+    {
+        case DSP_Option::Phase:
+            return "Phaser Bypass";
+        case DSP_Option::Chorus:
+            return "Chorus Bypass";
+        case DSP_Option::OverDrive:
+            return "OverDrive Bypass";
+        case DSP_Option::LadderFilter:
+            return "Ladder Filter Bypass";
+        case DSP_Option::GeneralFilter:
+            return "General Filter Bypass";
+        case DSP_Option::Delay:
+            return "Delay Bypass";
+        case DSP_Option::END_OF_LIST:
+            break;
+    }
+
+    return {};
+}
+
+/*
+ each module alone (and the overdrive oversampled), every module at once in a spread of
+ orders, and sweeps of the parameters whose changes have the most to get wrong.
+ */
+std::vector<GoldenConfig> getGoldenConfigs()
+{
+    std::vector<GoldenConfig> configs;
+
+    auto solo = [](DSP_Option option)
+    {
+        GoldenConfig config;
+        for( size_t i = 0; i < config.order.size(); ++i )
+            config.parameters.push_back({ getBypassParameterName(static_cast<DSP_Option>(i)), static_cast<DSP_Option>(i) == option ? 0.f : 1.f });
+
+        for( auto& parameter : getAudibleSettings(option) )
+            config.parameters.push_back(parameter);
+
+        return config;
+    };
+
+    for( size_t i = 0; i < static_cast<size_t>(DSP_Option::END_OF_LIST); ++i )
+    {
+        auto option = static_cast<DSP_Option>(i);
+        auto config = solo(option);
+        config.name = "solo-" + getDSPOptionName(option);
+        configs.push_back(config);
+    }
+
+    {
+        auto config = solo(DSP_Option::OverDrive);
+        config.name = "solo-OverDrive-4x";
+        config.parameters.push_back({ "OverDrive Oversampling", 2.f });
+        configs.push_back(config);
+    }
+
+    //6 orders spread over the permutations, and the last (the reverse of the first).
+    auto orders = getAllDSPOrders();
+    constexpr size_t numOrders = 6;
+    std::vector<size_t> orderIndices;
+    for( size_t i = 0; i < numOrders; ++i )
+        orderIndices.push_back(i * orders.size() / numOrders);
+    orderIndices.push_back(orders.size() - 1);
+
+    for( auto index : orderIndices )
+    {
+        GoldenConfig config;
+        config.name = "order-" + juce::String(static_cast<int>(index));
+        config.order = orders[index];
+        for( size_t i = 0; i < config.order.size(); ++i )
+        {
+            for( auto& parameter : getAudibleSettings(static_cast<DSP_Option>(i)) )
+                config.parameters.push_back(parameter);
+        }
+
+        configs.push_back(config);
+    }
+
+    auto sweep = [&](DSP_Option option, juce::String name, juce::String parameter, float from, float to)
+    {
+        auto config = solo(option);
+        config.name = "sweep-" + name;
+        config.sweptParameter = parameter;
+        config.sweepFrom = from;
+        config.sweepTo = to;
+        configs.push_back(config);
+    };
+
+    sweep(DSP_Option::LadderFilter, "LadderFilter-cutoff", "Ladder Filter Cutoff Hz", 20.f, 20000.f);
+    sweep(DSP_Option::OverDrive, "OverDrive-saturation", "OverDrive Saturation", 1.f, 100.f);
+    sweep(DSP_Option::GeneralFilter, "GeneralFilter-freq", "General Filter Freq hz", 20.f, 20000.f);
+    sweep(DSP_Option::Delay, "Delay-time", "Delay Time ms", 20.f, 500.f);
+
+    return configs;
+}
+
+juce::AudioBuffer<float> makeGoldenSignal(double sampleRate)
+{
+    const auto numSamples = juce::roundToInt(sampleRate);
+    juce::AudioBuffer<float> signal(2, numSamples);
+    signal.clear();
+
+    auto at = [sampleRate](double seconds) { return juce::roundToInt(seconds * sampleRate); };
+
+    for( int ch = 0; ch < signal.getNumChannels(); ++ch )
+    {
+        signal.setSample(ch, 0, 0.5f);
+        signal.setSample(ch, at(0.05), 0.5f);
+    }
+
+    //0.1s - 0.5s: phase = 2pi f0 T / ln(f1 / f0) * (e^(t / T * ln(f1 / f0)) - 1)
+    const auto sweepStart = at(0.1), sweepLength = at(0.4);
+    const auto f0 = 20.0, f1 = 20000.0, T = 0.4;
+    const auto k = std::log(f1 / f0);
+    for( int i = 0; i < sweepLength; ++i )
+    {
+        auto t = static_cast<double>(i) / sampleRate;
+        auto phase = juce::MathConstants<double>::twoPi * f0 * T / k * (std::exp(t / T * k) - 1.0);
+        auto sample = static_cast<float>(0.5 * std::sin(phase));
+        for( int ch = 0; ch < signal.getNumChannels(); ++ch )
+            signal.setSample(ch, sweepStart + i, sample);
+    }
+
+    //0.5s - 0.8s, then silence.
+    auto noise = makeNoise(signal.getNumChannels(), at(0.3));
+    for( int ch = 0; ch < signal.getNumChannels(); ++ch )
+        signal.copyFrom(ch, at(0.5), noise, ch, 0, noise.getNumSamples());
+
+    return signal;
+}
+
+/*
+ the configuration's render of 'signal'. 'seconds' gets the time spent in processBlock.
+ */
+juce::AudioBuffer<float> renderGolden(const GoldenConfig& config,
+                                      const juce::AudioBuffer<float>& signal,
+                                      double sampleRate,
+                                      int blockSize,
+                                      const BenchmarkSettings& settings,
+                                      double& seconds)
+{
+    const auto numChannels = signal.getNumChannels();
+
+    Project13AudioProcessor processor;
+    //the sub-block size changes when parameter updates land, so the renders pin it.
+    processor.subBlockSize.store(Project13AudioProcessor::defaultSubBlockSize);
+    //the order is in place from the first sample, not crossfaded in.
+    processor.crossfadeOrderChanges.store(false);
+    //non-realtime, so nothing waits on another thread and every render is the same.
+    //the oversampling stays the configuration's own.
+    processor.maxOversamplingWhenNonRealtime.store(false);
+    processor.setNonRealtime(true);
+
+    auto setParameter = [&processor](const juce::String& name, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(name);
+        jassert(parameter != nullptr);
+        if( parameter != nullptr )
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    };
+
+    for( auto& [name, value] : config.parameters )
+        setParameter(name, value);
+
+    if( config.sweptParameter.isNotEmpty() )
+        setParameter(config.sweptParameter, config.sweepFrom);
+
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+    processor.dspOrderFifo.push(config.order);
+
+    juce::AudioBuffer<float> output(signal);
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    const auto numSamples = signal.getNumSamples();
+    const auto numBlocks = (numSamples + blockSize - 1) / blockSize;
+    double totalNs = 0.0;
+
+    for( int i = 0; i < numBlocks; ++i )
+    {
+        const auto start = i * blockSize;
+        const auto n = juce::jmin(blockSize, numSamples - start);
+
+        if( config.sweptParameter.isNotEmpty() )
+            setParameter(config.sweptParameter, juce::jmap(static_cast<float>(i) / static_cast<float>(numBlocks), config.sweepFrom, config.sweepTo));
+
+        buffer.setSize(numChannels, n, false, false, true);
+        for( int ch = 0; ch < numChannels; ++ch )
+            buffer.copyFrom(ch, 0, signal, ch, start, n);
+
+        auto blockStart = std::chrono::steady_clock::now();
+        processor.processBlock(buffer, midi);
+        auto blockEnd = std::chrono::steady_clock::now();
+        totalNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(blockEnd - blockStart).count());
+
+        for( int ch = 0; ch < numChannels; ++ch )
+            output.copyFrom(ch, start, buffer, ch, 0, n);
+    }
+
+    processor.releaseResources();
+
+    seconds = totalNs * 1.0e-9;
+    return output;
+}
+
+/*
+ the CPU load of a fixed job that doesn't touch the plugin: every channel of 'signal' through
+ a cascade of 16 biquads, block by block. the fastest of 'runs'. golden budgets are relative to this.
+ */
+double measureReferenceLoad(const juce::AudioBuffer<float>& signal, double sampleRate, int blockSize, int runs)
+{
+    constexpr size_t numSections = 16;
+    const auto numChannels = static_cast<size_t>(signal.getNumChannels());
+    const juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(blockSize), 1 };
+    auto coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, 5000.f, 0.7f);
+
+    juce::AudioBuffer<float> buffer(signal);
+    auto fastest = std::numeric_limits<double>::max();
+
+    for( int run = 0; run < runs; ++run )
+    {
+        std::vector<juce::dsp::IIR::Filter<float>> filters(numChannels * numSections);
+        for( auto& filter : filters )
+        {
+            filter.coefficients = coefficients;
+            filter.prepare(spec);
+        }
+
+        buffer.makeCopyOf(signal, true);
+        juce::dsp::AudioBlock<float> block(buffer);
+
+        auto start = std::chrono::steady_clock::now();
+        for( size_t offset = 0; offset < block.getNumSamples(); offset += static_cast<size_t>(blockSize) )
+        {
+            auto subBlock = block.getSubBlock(offset, juce::jmin(static_cast<size_t>(blockSize), block.getNumSamples() - offset));
+            for( size_t ch = 0; ch < numChannels; ++ch )
+            {
+                auto channel = subBlock.getSingleChannelBlock(ch);
+                juce::dsp::ProcessContextReplacing<float> context(channel);
+                for( size_t i = 0; i < numSections; ++i )
+                    filters[ch * numSections + i].process(context);
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        fastest = juce::jmin(fastest, std::chrono::duration<double>(end - start).count());
+    }
+
+    return fastest * sampleRate / signal.getNumSamples();
+}
+
+bool writeGolden(const juce::File& file, const juce::AudioBuffer<float>& render, double sampleRate)
+{
+    file.deleteFile();
+    auto stream = file.createOutputStream();
+    if( stream == nullptr )
+        return false;
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(render.getNumChannels()), 32, {}, 0));
+    if( writer == nullptr )
+        return false;
+
+    //the writer owns the stream now.
+    stream.release();
+    return writer->writeFromAudioSampleBuffer(render, 0, render.getNumSamples());
+}
+
+/*
+ the golden render, or nothing if it's missing or doesn't have the render's shape.
+ */
+std::optional<juce::AudioBuffer<float>> readGolden(const juce::File& file, const juce::AudioBuffer<float>& render, double sampleRate)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if( reader == nullptr
+       || reader->sampleRate != sampleRate
+       || static_cast<int>(reader->numChannels) != render.getNumChannels()
+       || reader->lengthInSamples != render.getNumSamples() )
+        return {};
+
+    juce::AudioBuffer<float> golden(render.getNumChannels(), render.getNumSamples());
+    if( ! reader->read(&golden, 0, golden.getNumSamples(), 0, true, true) )
+        return {};
+
+    return golden;
+}
+
+/*
+ Benchmark/Golden, found by walking up from the executable to the directory holding
+ Project13Benchmark.jucer, so it works from any exporter's build folder. nothing if it isn't there.
+ */
+juce::File findGoldenDirectory()
+{
+    for( auto directory = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+         ! directory.isRoot();
+         directory = directory.getParentDirectory() )
+    {
+        if( directory.getChildFile("Project13Benchmark.jucer").existsAsFile() )
+            return directory.getChildFile("Golden");
+    }
+
+    return {};
+}
+
+/*
+ renders every configuration budgetRuns times, then records or checks it. returns the results
+ for the report. 'passed' is false if any render differs from its golden render by more than
+ the tolerance, is missing one, or with --check-budgets goes over its CPU budget.
+ */
+juce::Array<juce::var> runGoldenSuite(const BenchmarkSettings& settings, bool& passed)
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+
+    const auto& directory = settings.goldenDirectory;
+    auto budgetsFile = directory.getChildFile("budgets.json");
+    auto budgets = juce::JSON::parse(budgetsFile);
+    juce::DynamicObject::Ptr newBudgets = new juce::DynamicObject();
+
+    auto signal = makeGoldenSignal(sampleRate);
+    const auto signalSeconds = signal.getNumSamples() / sampleRate;
+
+    juce::Array<juce::var> results;
+    passed = true;
+
+    if( settings.updateGolden && directory.createDirectory().failed() )
+    {
+        std::cerr << "could not create " << directory.getFullPathName() << std::endl;
+        passed = false;
+        return results;
+    }
+
+    const auto referenceLoad = measureReferenceLoad(signal, sampleRate, blockSize, settings.budgetRuns);
+
+    for( auto& config : getGoldenConfigs() )
+    {
+        double seconds = 0.0;
+        auto render = renderGolden(config, signal, sampleRate, blockSize, settings, seconds);
+
+        //the fastest run: the one least disturbed by everything else on the machine.
+        for( int run = 1; run < settings.budgetRuns; ++run )
+        {
+            double runSeconds = 0.0;
+            renderGolden(config, signal, sampleRate, blockSize, settings, runSeconds);
+            seconds = juce::jmin(seconds, runSeconds);
+        }
+
+        const auto load = seconds / signalSeconds;
+        const auto cost = load / referenceLoad;
+        const auto file = directory.getChildFile(config.name + ".wav");
+
+        juce::DynamicObject::Ptr result = new juce::DynamicObject();
+        result->setProperty("name", config.name);
+        result->setProperty("cpuLoad", load);
+        result->setProperty("referenceLoad", referenceLoad);
+        result->setProperty("cpuCost", cost);
+
+        if( settings.updateGolden )
+        {
+            auto budget = cost * settings.budgetHeadroom;
+            newBudgets->setProperty(config.name, budget);
+            result->setProperty("cpuBudget", budget);
+
+            if( ! writeGolden(file, render, sampleRate) )
+            {
+                std::cerr << "could not write " << file.getFullPathName() << std::endl;
+                passed = false;
+            }
+
+            std::cerr << "recorded " << config.name << std::endl;
+            results.add(result.get());
+            continue;
+        }
+
+        auto configPassed = true;
+        if( auto golden = readGolden(file, render, sampleRate) )
+        {
+            float maxAbsDifference = 0.f;
+            for( int ch = 0; ch < render.getNumChannels(); ++ch )
+            {
+                for( int n = 0; n < render.getNumSamples(); ++n )
+                    maxAbsDifference = juce::jmax(maxAbsDifference, std::abs(render.getSample(ch, n) - golden->getSample(ch, n)));
+            }
+
+            result->setProperty("maxAbsDifference", maxAbsDifference);
+            if( maxAbsDifference > settings.goldenTolerance )
+            {
+                std::cerr << config.name << ": differs from its golden render by " << juce::Decibels::gainToDecibels(maxAbsDifference) << "dB" << std::endl;
+                configPassed = false;
+            }
+        }
+        else
+        {
+            std::cerr << config.name << ": no golden render at " << file.getFullPathName() << ", record them with --update-golden" << std::endl;
+            configPassed = false;
+        }
+
+        auto budget = budgets[juce::Identifier(config.name)];
+        if( ! budget.isVoid() )
+            result->setProperty("cpuBudget", budget);
+
+        if( settings.checkBudgets && budget.isVoid() )
+        {
+            std::cerr << config.name << ": no CPU budget in " << budgetsFile.getFullPathName() << std::endl;
+            configPassed = false;
+        }
+        else if( settings.checkBudgets && cost > static_cast<double>(budget) )
+        {
+            std::cerr << config.name << ": costs " << cost << "x the reference, over its budget of " << static_cast<double>(budget) << "x" << std::endl;
+            configPassed = false;
+        }
+
+        result->setProperty("passed", configPassed);
+        results.add(result.get());
+
+        std::cerr << (configPassed ? "ok   " : "FAIL ") << config.name << std::endl;
+        passed = passed && configPassed;
+    }
+
+    if( settings.updateGolden && ! budgetsFile.replaceWithText(juce::JSON::toString(newBudgets.get())) )
+    {
+        std::cerr << "could not write " << budgetsFile.getFullPathName() << std::endl;
+        passed = false;
+    }
+
+    return results;
+}
+
+/*
+ microseconds per getStateInformation / setStateInformation call for one instance, for each
+ StateFormat, and the size of the saved state. 'numInstances' processors each save and load
+ their own state, the way a host does when it opens a project.
+ */
+juce::var runStateBenchmark(int numInstances, const BenchmarkSettings& settings)
+{
+    using StateFormat = Project13AudioProcessor::StateFormat;
+
+    std::vector<std::unique_ptr<Project13AudioProcessor>> processors;
+    for( int i = 0; i < numInstances; ++i )
+    {
+        processors.push_back(std::make_unique<Project13AudioProcessor>());
+
+        //move every parameter away from its default, so nothing is skipped as unchanged.
+        juce::Random random(i);
+        for( auto* parameter : processors.back()->getParameters() )
+            parameter->setValueNotifyingHost(random.nextFloat());
+    }
+
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("numInstances", numInstances);
+
+    auto formats = std::array { std::pair { StateFormat::Binary, "binary" }, std::pair { StateFormat::ValueTree, "valueTree" } };
+    for( auto [format, name] : formats )
+    {
+        std::vector<juce::MemoryBlock> states(processors.size());
+
+        const auto numRounds = juce::jmax(1, juce::roundToInt(settings.secondsPerRun * 20));
+        double saveNs = 0.0, loadNs = 0.0;
+
+        for( int round = 0; round < numRounds; ++round )
+        {
+            auto start = std::chrono::steady_clock::now();
+            for( size_t i = 0; i < processors.size(); ++i )
+            {
+                states[i].reset();
+                processors[i]->writeState(states[i], format);
+            }
+            auto saved = std::chrono::steady_clock::now();
+            for( size_t i = 0; i < processors.size(); ++i )
+                processors[i]->setStateInformation(states[i].getData(), static_cast<int>(states[i].getSize()));
+            auto loaded = std::chrono::steady_clock::now();
+
+            saveNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(saved - start).count());
+            loadNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(loaded - saved).count());
+        }
+
+        const auto numCalls = static_cast<double>(numRounds) * numInstances;
+
+        juce::DynamicObject::Ptr formatResult = new juce::DynamicObject();
+        formatResult->setProperty("bytes", static_cast<int>(states.front().getSize()));
+        formatResult->setProperty("saveUs", saveNs / numCalls * 1.0e-3);
+        formatResult->setProperty("loadUs", loadNs / numCalls * 1.0e-3);
+        result->setProperty(name, formatResult.get());
+    }
+
+    return result.get();
+}
+
+/*
+ ns/sample of a stock JUCE filter against its SIMDFilters replacement on the same input,
+ plus the largest difference between their outputs (0 when they're bit identical).
+ */
+template<typename Stock, typename Replacement>
+juce::var compareFilterKernels(Stock& stock,
+                               Replacement& replacement,
+                               int blockSize,
+                               const juce::AudioBuffer<float>& noise,
+                               int numBlocks,
+                               const BenchmarkSettings& settings)
+{
+    juce::AudioBuffer<float> stockBuffer(noise.getNumChannels(), blockSize);
+    juce::AudioBuffer<float> replacementBuffer(noise.getNumChannels(), blockSize);
+
+    auto timeProcess = [](auto& dsp, juce::AudioBuffer<float>& buffer)
+    {
+        auto block = juce::dsp::AudioBlock<float>(buffer);
+        auto context = juce::dsp::ProcessContextReplacing<float>(block);
+
+        auto start = std::chrono::steady_clock::now();
+        dsp.process(context);
+        auto end = std::chrono::steady_clock::now();
+
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    };
+
+    double stockNs = 0.0, replacementNs = 0.0;
+    float maxAbsDifference = 0.f;
+    int readPosition = 0;
+
+    for( int i = 0; i < numBlocks + settings.warmupBlocks; ++i )
+    {
+        if( readPosition + blockSize > noise.getNumSamples() )
+            readPosition = 0;
+
+        for( int ch = 0; ch < noise.getNumChannels(); ++ch )
+        {
+            stockBuffer.copyFrom(ch, 0, noise, ch, readPosition, blockSize);
+            replacementBuffer.copyFrom(ch, 0, noise, ch, readPosition, blockSize);
+        }
+
+        readPosition += blockSize;
+
+        auto ns = timeProcess(stock, stockBuffer);
+        auto replacementBlockNs = timeProcess(replacement, replacementBuffer);
+
+        if( i >= settings.warmupBlocks )
+        {
+            stockNs += ns;
+            replacementNs += replacementBlockNs;
+        }
+
+        for( int ch = 0; ch < noise.getNumChannels(); ++ch )
+        {
+            for( int n = 0; n < blockSize; ++n )
+                maxAbsDifference = juce::jmax(maxAbsDifference, std::abs(stockBuffer.getSample(ch, n) - replacementBuffer.getSample(ch, n)));
+        }
+    }
+
+    const auto numSamples = static_cast<double>(numBlocks) * blockSize;
+
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("stockNsPerSample", stockNs / numSamples);
+    result->setProperty("simdNsPerSample", replacementNs / numSamples);
+    result->setProperty("maxAbsDifference", maxAbsDifference);
+    return result.get();
+}
+
+/*
+ the General Filter and Ladder Filter kernels, stock against SIMD, on stereo noise.
+ */
+juce::var runFilterKernelBenchmark(double sampleRate,
+                                   int blockSize,
+                                   const juce::AudioBuffer<float>& noise,
+                                   const BenchmarkSettings& settings)
+{
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(blockSize);
+    spec.numChannels = static_cast<juce::uint32>(noise.getNumChannels());
+
+    const auto numBlocks = juce::jmax(1, juce::roundToInt(settings.secondsPerRun * sampleRate / blockSize));
+
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("sampleRate", sampleRate);
+    result->setProperty("blockSize", blockSize);
+
+    {
+        auto coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, 1000.f, 1.f, 2.f);
+
+        juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> stock;
+        *stock.state = *coefficients;
+        stock.prepare(spec);
+
+        SIMDBiquad replacement;
+        *replacement.state = *coefficients;
+        replacement.prepare(spec);
+
+        result->setProperty("biquad", compareFilterKernels(stock, replacement, blockSize, noise, numBlocks, settings));
+    }
+
+    {
+        auto configure = [&](auto& ladder)
+        {
+            ladder.prepare(spec);
+            ladder.setMode(juce::dsp::LadderFilterMode::LPF24);
+            ladder.setCutoffFrequencyHz(1000.f);
+            ladder.setResonance(0.5f);
+            ladder.setDrive(4.f);
+            ladder.reset();
+        };
+
+        juce::dsp::LadderFilter<float> stock;
+        configure(stock);
+
+        SIMDLadderFilter replacement;
+        configure(replacement);
+
+        result->setProperty("ladder", compareFilterKernels(stock, replacement, blockSize, noise, numBlocks, settings));
+    }
+
+    return result.get();
+}
+
+#if PROJECT13_RT_CHECK
+/*
+ prints every recorded violation and returns them for the report.
+ */
+juce::Array<juce::var> reportRealtimeViolations()
+{
+    juce::Array<juce::var> violations;
+    for( auto& violation : RealtimeCheck::getViolations() )
+    {
+        juce::DynamicObject::Ptr v = new juce::DynamicObject();
+        v->setProperty("kind", RealtimeCheck::getKindName(violation.kind));
+        v->setProperty("function", violation.function);
+        v->setProperty("slot", violation.slot);
+        v->setProperty("module", violation.module);
+        violations.add(v.get());
+
+        std::cerr << "real-time violation: " << RealtimeCheck::getKindName(violation.kind) << " (" << violation.function << ") in ";
+        if( violation.slot == RealtimeCheck::outsideChain )
+            std::cerr << "processBlock, outside the chain" << std::endl;
+        else
+            std::cerr << "slot " << violation.slot << " (" << violation.module << ")" << std::endl;
+    }
+
+    return violations;
+}
+
+/*
+ Timings in this build pay for the interposition on every call, so it only drives the
+ processor through everything that reconfigures the chain on the audio thread, with every
+ module audible, and reports what blocked. Between blocks, from this thread, the way a
+ host's message thread would:
+    the overdrive's and ladder's oversampling factors and the oversampling filter
+    order changes through a spread of the permutations
+    program changes
+    non-realtime on and off, which takes both modules to the highest factor
+ and on every block a mapped CC sweeping the ladder cutoff. 2 - 5s of every 8 are silent, so
+ the chain goes to sleep with switches pending and wakes with them applied.
+ */
+juce::var runRealtimeExercise(const BenchmarkSettings& settings)
+{
+    constexpr int controller = 74;
+    constexpr double secondsPerRun = 8.0;
+    //a switch every 50ms, taking turns.
+    constexpr double switchIntervalSeconds = 0.05;
+
+    auto orders = getAllDSPOrders();
+    juce::Array<juce::var> runs;
+
+    //program changes need a bank to pick from: the audible settings, and the same oversampled.
+    juce::TemporaryFile bank(".p13bank");
+    {
+        Project13AudioProcessor source(bank.getFile());
+        applyAudibleSettings(source);
+        source.savePreset("Audible", bank.getFile());
+
+        if( auto* oversampling = source.apvts.getParameter("OverDrive Oversampling") )
+            oversampling->setValueNotifyingHost(oversampling->convertTo0to1(2.f));
+
+        source.savePreset("Audible 4x", bank.getFile());
+    }
+
+    for( auto sampleRate : { 44100.0, 96000.0 } )
+    {
+        auto noise = makeNoise(2, static_cast<int>(sampleRate) * 2);
+
+        //smaller than a sub-block, and several sub-blocks.
+        for( auto blockSize : { 32, 1024 } )
+        {
+            Project13AudioProcessor processor(bank.getFile());
+            processor.subBlockSize.store(settings.subBlockSize);
+            processor.setNonRealtime(false);
+
+            auto setParameter = [&processor](const juce::String& name, float value)
+            {
+                auto* parameter = processor.apvts.getParameter(name);
+                jassert(parameter != nullptr);
+                if( parameter != nullptr )
+                    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+            };
+
+            applyAudibleSettings(processor);
+
+            if( auto* cutoff = processor.apvts.getParameter("Ladder Filter Cutoff Hz") )
+                processor.midiLearn.setMapping(controller, cutoff->getParameterIndex());
+
+            processor.setPlayConfigDetails(noise.getNumChannels(), noise.getNumChannels(), sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            juce::AudioBuffer<float> buffer(noise.getNumChannels(), blockSize);
+            juce::MidiBuffer midi;
+
+            const auto numBlocks = juce::roundToInt(secondsPerRun * sampleRate / blockSize);
+            const auto switchInterval = juce::jmax(1, juce::roundToInt(switchIntervalSeconds * sampleRate / blockSize));
+            const auto violationsBefore = RealtimeCheck::getNumViolations();
+            int readPosition = 0;
+            int numSwitches = 0;
+
+            for( int i = 0; i < numBlocks; ++i )
+            {
+                if( i % switchInterval == 0 )
+                {
+                    const auto step = numSwitches / 4;
+                    switch (numSwitches % 4)
+                    {
+                        case 0:
+                            setParameter("OverDrive Oversampling", static_cast<float>(step % 4));
+                            setParameter("Ladder Filter Oversampling", static_cast<float>((step + 2) % 4));
+                            setParameter("Oversampling Filter", static_cast<float>(step / 4 % 2));
+                            break;
+                        case 1:
+                            processor.dspOrderFifo.push(orders[static_cast<size_t>(step * 97) % orders.size()]);
+                            break;
+                        case 2:
+                            processor.setCurrentProgram(step % processor.getNumPrograms());
+                            break;
+                        case 3:
+                            processor.setNonRealtime(! processor.isNonRealtime());
+                            break;
+                    }
+
+                    ++numSwitches;
+                }
+
+                const auto seconds = i * blockSize / sampleRate;
+                if( seconds >= 2.0 && seconds < 5.0 )
+                {
+                    buffer.clear();
+                }
+                else
+                {
+                    if( readPosition + blockSize > noise.getNumSamples() )
+                        readPosition = 0;
+
+                    for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+                        buffer.copyFrom(ch, 0, noise, ch, readPosition, blockSize);
+
+                    readPosition += blockSize;
+                }
+
+                midi.clear();
+                midi.addEvent(juce::MidiMessage::controllerEvent(1, controller, 127 * i / numBlocks), 0);
+
+                processor.processBlock(buffer, midi);
+            }
+
+            processor.releaseResources();
+
+            juce::DynamicObject::Ptr run = new juce::DynamicObject();
+            run->setProperty("sampleRate", sampleRate);
+            run->setProperty("blockSize", blockSize);
+            run->setProperty("numSwitches", numSwitches);
+            run->setProperty("numRealtimeViolations", RealtimeCheck::getNumViolations() - violationsBefore);
+            runs.add(run.get());
+
+            std::cerr << "exercised " << sampleRate << "Hz / " << blockSize << " samples" << std::endl;
+        }
+    }
+
+    return runs;
+}
+#endif
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for( int i = 1; i < argc; ++i )
+        args.add(argv[i]);
+
+    auto settings = parseArgs(args);
+
+   #if PROJECT13_GOLDEN_TEST
+    if( settings.goldenDirectory == juce::File() )
+        settings.goldenDirectory = findGoldenDirectory();
+
+    if( settings.goldenDirectory == juce::File() )
+    {
+        std::cerr << "no golden directory: pass --golden <dir>" << std::endl;
+        return 1;
+    }
+   #endif
+
+   #if PROJECT13_RT_CHECK
+    juce::DynamicObject::Ptr report = new juce::DynamicObject();
+    report->setProperty("benchmark", "realtimeCheck");
+    report->setProperty("results", runRealtimeExercise(settings));
+    report->setProperty("realtimeViolations", reportRealtimeViolations());
+    report->setProperty("numRealtimeViolations", RealtimeCheck::getNumViolations());
+
+    auto json = juce::JSON::toString(report.get());
+    if( settings.outputFile != juce::File() )
+        settings.outputFile.replaceWithText(json);
+    else
+        std::cout << json << std::endl;
+
+    //anything that could block inside processBlock fails the run, see RealtimeCheck.h.
+    return RealtimeCheck::getNumViolations() == 0 ? 0 : 1;
+   #else
+    if( settings.traceFile != juce::File() )
+    {
+        if( ! writeTrace(settings.traceFile, makeNoise(2, 48000 * 2), settings) )
+        {
+            std::cerr << "could not write " << settings.traceFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cerr << "wrote " << settings.traceFile.getFullPathName() << std::endl;
+        return 0;
+    }
+
+    if( settings.goldenDirectory != juce::File() )
+    {
+        auto passed = true;
+        juce::DynamicObject::Ptr report = new juce::DynamicObject();
+        report->setProperty("benchmark", settings.updateGolden ? "updateGolden" : "golden");
+        report->setProperty("results", runGoldenSuite(settings, passed));
+
+        auto json = juce::JSON::toString(report.get());
+        if( settings.outputFile != juce::File() )
+            settings.outputFile.replaceWithText(json);
+        else
+            std::cout << json << std::endl;
+
+        return passed ? 0 : 1;
+    }
+
+    auto orders = getAllDSPOrders();
+    if( ! settings.allOrders )
+    {
+        //each option once, in declaration order
+        orders = { DSP_Order{{ DSP_Option::Phase, DSP_Option::Chorus, DSP_Option::OverDrive, DSP_Option::LadderFilter, DSP_Option::GeneralFilter, DSP_Option::Delay }} };
+    }
+
+    juce::Array<juce::var> results;
+    //total ns/sample and run count per dispatch, for the summary.
+    std::map<bool, std::pair<double, int>> dispatchTotals;
+
+    for( auto sampleRate : getSampleRates() )
+    {
+        //a few seconds of noise, looped.
+        auto noise = makeNoise(2, static_cast<int>(sampleRate) * 2);
+
+        for( auto blockSize : getBlockSizes() )
+        {
+            for( auto& order : orders )
+            {
+                for( auto staticDispatch : settings.staticDispatch )
+                {
+                    for( auto numChannels : settings.channelCounts )
+                    {
+                        auto result = runProcessBlockBenchmark(sampleRate, blockSize, order, staticDispatch, numChannels, noise, settings);
+                        auto& totals = dispatchTotals[staticDispatch];
+                        totals.first += static_cast<double>(result["nsPerSample"]);
+                        totals.second += 1;
+                        results.add(result);
+                    }
+                }
+            }
+
+            std::cerr << "finished " << sampleRate << "Hz / " << blockSize << " samples" << std::endl;
+        }
+    }
+
+    juce::Array<juce::var> overdriveResults;
+    {
+        auto noise = makeNoise(2, 48000 * 2);
+        for( auto drive : { 2.f, 10.f, 50.f } )
+            overdriveResults.add(runOverdriveBenchmark(48000.0, 512, drive, noise, settings));
+    }
+
+    juce::Array<juce::var> filterKernelResults;
+    {
+        auto noise = makeNoise(2, 48000 * 2);
+        for( auto blockSize : { 64, 512 } )
+            filterKernelResults.add(runFilterKernelBenchmark(48000.0, blockSize, noise, settings));
+    }
+
+    juce::Array<juce::var> midiCCResults;
+    {
+        auto noise = makeNoise(2, 48000 * 2);
+        for( auto ccInterval : { 0, 256, 64, 16, 1 } )
+            midiCCResults.add(runMidiCCBenchmark(48000.0, 512, ccInterval, noise, settings));
+    }
+
+    auto stateResult = runStateBenchmark(100, settings);
+
+    juce::DynamicObject::Ptr report = new juce::DynamicObject();
+    report->setProperty("benchmark", "processBlock");
+    report->setProperty("secondsPerRun", settings.secondsPerRun);
+    report->setProperty("results", results);
+
+    juce::DynamicObject::Ptr summary = new juce::DynamicObject();
+    for( auto& [staticDispatch, totals] : dispatchTotals )
+        summary->setProperty(staticDispatch ? "staticMeanNsPerSample" : "virtualMeanNsPerSample", totals.first / totals.second);
+    report->setProperty("summary", summary.get());
+    report->setProperty("overdrive", overdriveResults);
+    report->setProperty("filterKernels", filterKernelResults);
+    report->setProperty("midiCC", midiCCResults);
+    report->setProperty("state", stateResult);
+
+    auto json = juce::JSON::toString(report.get());
+
+    if( settings.outputFile != juce::File() )
+    {
+        if( ! settings.outputFile.replaceWithText(json) )
+        {
+            std::cerr << "could not write " << settings.outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << json << std::endl;
+    }
+
+    return 0;
+   #endif
+}
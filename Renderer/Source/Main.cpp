@@ -0,0 +1,430 @@
+/*
+  ==============================================================================
+
+    Headless file renderer for Project13AudioProcessor.
+
+    Streams WAV/AIFF/FLAC files through the processor in fixed chunks and
+    writes the results. Many files render concurrently, one processor per
+    worker, so a library of stems goes through the same chain on every core.
+
+    Project13Renderer [options] --output <dir> <files or directories...>
+
+        --state <file>      a state blob, as getStateInformation() writes it
+        --preset <name|n>   a preset from the bank, by name or index
+        --bank <file>       the bank --preset reads. the plugin's bank by default
+        --format <ext>      wav, aiff or flac. the input's format by default
+        --bits <n>          the output bit depth. the input's by default
+        --chunk <n>         samples per processBlock call
+        --jobs <n>          files rendered at once. one per core by default
+        --tail <seconds>    rendered after the input ends. the processor's tail by default
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+#include <cmath>
+#include <iostream>
+
+struct RenderSettings
+{
+    juce::File stateFile;
+    juce::String preset;
+    juce::File bankFile = Project13AudioProcessor::getPresetBankFile();
+    //empty: the input's extension.
+    juce::String format;
+    //0: the input's bit depth.
+    int bitsPerSample = 0;
+    int chunkSize = 512;
+    int numJobs = juce::SystemStats::getNumCpus();
+    //negative: Project13AudioProcessor::getTailLengthSeconds().
+    double tailSeconds = -1.0;
+    juce::File outputDirectory;
+    juce::Array<juce::File> inputs;
+};
+
+RenderSettings parseArgs(const juce::StringArray& args)
+{
+    RenderSettings settings;
+    auto cwd = juce::File::getCurrentWorkingDirectory();
+
+    for( int i = 0; i < args.size(); ++i )
+    {
+        auto& arg = args[i];
+
+        if( arg == "--state" && i + 1 < args.size() )
+            settings.stateFile = cwd.getChildFile(args[++i]);
+        else if( arg == "--preset" && i + 1 < args.size() )
+            settings.preset = args[++i];
+        else if( arg == "--bank" && i + 1 < args.size() )
+            settings.bankFile = cwd.getChildFile(args[++i]);
+        else if( arg == "--format" && i + 1 < args.size() )
+            settings.format = args[++i].trimCharactersAtStart(".").toLowerCase();
+        else if( arg == "--bits" && i + 1 < args.size() )
+            settings.bitsPerSample = juce::jmax(0, args[++i].getIntValue());
+        else if( arg == "--chunk" && i + 1 < args.size() )
+            settings.chunkSize = juce::jlimit(1, 65536, args[++i].getIntValue());
+        else if( arg == "--jobs" && i + 1 < args.size() )
+            settings.numJobs = juce::jmax(1, args[++i].getIntValue());
+        else if( arg == "--tail" && i + 1 < args.size() )
+            settings.tailSeconds = args[++i].getDoubleValue();
+        else if( arg == "--output" && i + 1 < args.size() )
+            settings.outputDirectory = cwd.getChildFile(args[++i]);
+        else
+        {
+            auto input = cwd.getChildFile(arg);
+            if( input.isDirectory() )
+            {
+                //sorted, so batches render in the same order every time.
+                auto files = input.findChildFiles(juce::File::findFiles, false, "*.wav;*.wave;*.aif;*.aiff;*.flac");
+                files.sort();
+                settings.inputs.addArray(files);
+            }
+            else
+                settings.inputs.add(input);
+        }
+    }
+
+    return settings;
+}
+
+/*
+ the state every worker's processor starts from: the --state file, the --preset from the bank,
+ or nothing, for the defaults. false, with a message, if it can't be found.
+ */
+bool loadState(const RenderSettings& settings, juce::MemoryBlock& state)
+{
+    if( settings.stateFile != juce::File() )
+    {
+        if( ! settings.stateFile.loadFileAsData(state) || state.isEmpty() )
+        {
+            std::cerr << "could not read " << settings.stateFile.getFullPathName() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    if( settings.preset.isEmpty() )
+        return true;
+
+    //a number is an index, anything else a name.
+    auto isIndex = settings.preset.containsOnly("0123456789");
+    auto index = settings.preset.getIntValue();
+    int presetIndex = 0;
+    juce::StringArray names;
+
+    auto loaded = PresetBank::load(settings.bankFile, [&](const juce::String& name, const BinaryState& preset)
+    {
+        if( state.isEmpty() && (isIndex ? presetIndex == index : name == settings.preset) )
+            preset.write(state);
+
+        names.add(name);
+        ++presetIndex;
+    });
+
+    if( ! loaded )
+    {
+        std::cerr << "could not read the preset bank " << settings.bankFile.getFullPathName() << std::endl;
+        return false;
+    }
+
+    if( state.isEmpty() )
+    {
+        std::cerr << "no preset '" << settings.preset << "' in " << settings.bankFile.getFullPathName() << ". the bank has:" << std::endl;
+        for( int i = 0; i < names.size(); ++i )
+            std::cerr << "    " << i << ": " << names[i] << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+struct RenderJob
+{
+    juce::File input, output;
+    juce::int64 lengthInSamples = 0;
+};
+
+/*
+ shared by the workers: the next job to take, and the totals the main thread reports.
+ */
+struct RenderQueue
+{
+    std::vector<RenderJob> jobs;
+    std::atomic<size_t> nextJob { 0 };
+
+    std::atomic<juce::int64> samplesRendered { 0 };
+    std::atomic<int> numFinished { 0 };
+    std::atomic<int> numFailed { 0 };
+
+    //workers report failures as they happen. the lock keeps the lines whole.
+    juce::CriticalSection logLock;
+    void logError(const juce::String& message)
+    {
+        const juce::ScopedLock lock(logLock);
+        std::cerr << std::endl << message << std::endl;
+    }
+};
+
+/*
+ renders jobs until there are none left, with its own processor. memory stays at one chunk
+ per worker however long the files are: input is read, processed and written a chunk at a time.
+ */
+struct RenderWorker : juce::Thread
+{
+    RenderWorker(RenderQueue& q, const RenderSettings& s, const juce::MemoryBlock& state) :
+        juce::Thread("Render Worker"),
+        queue(q),
+        settings(s)
+    {
+        formatManager.registerBasicFormats();
+
+        //offline: the processor takes its non-realtime settings, e.g. maximum oversampling.
+        processor.setNonRealtime(true);
+        //the saved order arrives through the order fifo. it has to be in place from the first sample of every file.
+        processor.crossfadeOrderChanges.store(false);
+        if( ! state.isEmpty() )
+            processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    }
+
+    ~RenderWorker() override
+    {
+        stopThread(-1);
+    }
+
+    void run() override
+    {
+        while( ! threadShouldExit() )
+        {
+            auto index = queue.nextJob.fetch_add(1);
+            if( index >= queue.jobs.size() )
+                return;
+
+            auto& job = queue.jobs[index];
+            if( auto error = render(job); error.isNotEmpty() )
+            {
+                job.output.deleteFile();
+                queue.logError(job.input.getFullPathName() + ": " + error);
+                queue.numFailed.fetch_add(1);
+            }
+
+            queue.numFinished.fetch_add(1);
+        }
+    }
+
+private:
+    //empty if it rendered.
+    juce::String render(const RenderJob& job)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(job.input));
+        if( reader == nullptr )
+            return "not a readable audio file";
+
+        auto numChannels = static_cast<int>(reader->numChannels);
+        if( numChannels < 1 || numChannels > 2 )
+            return "only mono and stereo files can be rendered";
+
+        auto extension = settings.format.isNotEmpty() ? "." + settings.format : job.output.getFileExtension();
+        auto* format = formatManager.findFormatForFileExtension(extension);
+        if( format == nullptr )
+            return "no format for " + extension;
+
+        //the requested depth, or the input's, if the format can write it. its deepest otherwise.
+        auto depths = format->getPossibleBitDepths();
+        auto bits = settings.bitsPerSample > 0 ? settings.bitsPerSample : static_cast<int>(reader->bitsPerSample);
+        if( ! depths.contains(bits) )
+            bits = depths.getLast();
+
+        job.output.deleteFile();
+        auto stream = job.output.createOutputStream();
+        if( stream == nullptr )
+            return "could not write " + job.output.getFullPathName();
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(),
+                                                                                reader->sampleRate,
+                                                                                static_cast<unsigned int>(numChannels),
+                                                                                bits,
+                                                                                {},
+                                                                                0));
+        if( writer == nullptr )
+            return "could not write " + job.output.getFullPathName() + " at " + juce::String(bits) + " bits";
+
+        //the writer owns the stream now.
+        stream.release();
+
+        const auto sampleRate = reader->sampleRate;
+        const auto chunkSize = settings.chunkSize;
+        processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, chunkSize);
+        processor.prepareToPlay(sampleRate, chunkSize);
+
+        /*
+         the chain's latency is trimmed off the start, and made up with silence at the end,
+         so the output lines up with the input. the tail is rendered after that.
+         */
+        const juce::int64 latency = processor.getLatencySamples();
+        const auto length = reader->lengthInSamples;
+
+        juce::AudioBuffer<float> buffer(numChannels, chunkSize);
+        juce::MidiBuffer midi;
+        juce::int64 position = 0;
+
+        auto renderUntil = [&](juce::int64 end) -> juce::String
+        {
+            while( position < end && ! threadShouldExit() )
+            {
+                auto numSamples = static_cast<int>(juce::jmin<juce::int64>(chunkSize, end - position));
+                buffer.setSize(numChannels, numSamples, false, false, true);
+
+                auto numInput = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, length - position));
+                if( numInput > 0 && ! reader->read(&buffer, 0, numInput, position, true, true) )
+                    return "read failed";
+
+                if( numInput < numSamples )
+                    buffer.clear(numInput, numSamples - numInput);
+
+                processor.processBlock(buffer, midi);
+                midi.clear();
+
+                auto skip = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, latency - position));
+                if( skip < numSamples && ! writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip) )
+                    return "write failed";
+
+                position += numSamples;
+                queue.samplesRendered.fetch_add(numInput);
+            }
+
+            return {};
+        };
+
+        if( auto error = renderUntil(length + latency); error.isNotEmpty() )
+            return error;
+
+        //the tail follows the settings the chain has been running with, so it's only known once the input is through.
+        const auto tailSeconds = settings.tailSeconds >= 0.0 ? settings.tailSeconds : processor.getTailLengthSeconds();
+        const auto tail = static_cast<juce::int64>(std::ceil(tailSeconds * sampleRate));
+        if( auto error = renderUntil(length + latency + tail); error.isNotEmpty() )
+            return error;
+
+        processor.releaseResources();
+        return threadShouldExit() ? "cancelled" : juce::String();
+    }
+
+    RenderQueue& queue;
+    const RenderSettings& settings;
+
+    juce::AudioFormatManager formatManager;
+    Project13AudioProcessor processor;
+};
+
+/*
+ one job per readable input. the lengths are only for the progress.
+ false, with a message, if the inputs can't all be rendered.
+ */
+bool makeJobs(const RenderSettings& settings, RenderQueue& queue)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    for( auto& input : settings.inputs )
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+        if( reader == nullptr )
+        {
+            std::cerr << "not a readable audio file: " << input.getFullPathName() << std::endl;
+            return false;
+        }
+
+        auto name = settings.format.isNotEmpty() ? input.getFileNameWithoutExtension() + "." + settings.format : input.getFileName();
+        auto output = settings.outputDirectory.getChildFile(name);
+        if( output == input )
+        {
+            std::cerr << "would overwrite its input: " << input.getFullPathName() << std::endl;
+            return false;
+        }
+
+        queue.jobs.push_back({ input, output, reader->lengthInSamples });
+    }
+
+    return true;
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for( int i = 1; i < argc; ++i )
+        args.add(argv[i]);
+
+    auto settings = parseArgs(args);
+    if( settings.inputs.isEmpty() || settings.outputDirectory == juce::File() )
+    {
+        std::cerr << "usage: Project13Renderer [--state <file> | --preset <name|index> [--bank <file>]] "
+                     "[--format wav|aiff|flac] [--bits <n>] [--chunk <n>] [--jobs <n>] [--tail <seconds>] "
+                     "--output <dir> <files or directories...>" << std::endl;
+        return 1;
+    }
+
+    juce::MemoryBlock state;
+    if( ! loadState(settings, state) )
+        return 1;
+
+    RenderQueue queue;
+    if( ! makeJobs(settings, queue) )
+        return 1;
+
+    if( settings.outputDirectory.createDirectory().failed() )
+    {
+        std::cerr << "could not create " << settings.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::int64 totalSamples = 0;
+    for( auto& job : queue.jobs )
+        totalSamples += job.lengthInSamples;
+
+    //the processors are built here, on the message thread, and only used on their worker.
+    auto numWorkers = juce::jmin(settings.numJobs, static_cast<int>(queue.jobs.size()));
+    std::vector<std::unique_ptr<RenderWorker>> workers;
+    for( int i = 0; i < numWorkers; ++i )
+        workers.push_back(std::make_unique<RenderWorker>(queue, settings, state));
+
+    const auto numFiles = static_cast<int>(queue.jobs.size());
+    std::cerr << "rendering " << numFiles << " files on " << numWorkers << " workers" << std::endl;
+
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    for( auto& worker : workers )
+        worker->startThread();
+
+    auto printProgress = [&]()
+    {
+        auto fraction = totalSamples > 0 ? static_cast<double>(queue.samplesRendered.load()) / static_cast<double>(totalSamples) : 1.0;
+
+        const juce::ScopedLock lock(queue.logLock);
+        std::cerr << "\r" << queue.numFinished.load() << "/" << numFiles << " files, "
+                  << juce::roundToInt(fraction * 100.0) << "%" << std::flush;
+    };
+
+    for( auto& worker : workers )
+    {
+        while( ! worker->waitForThreadToExit(250) )
+            printProgress();
+    }
+
+    printProgress();
+    workers.clear();
+
+    auto seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    std::cerr << std::endl << "rendered " << numFiles - queue.numFailed.load() << " files in "
+              << juce::String(seconds, 2) << "s";
+    if( queue.numFailed.load() > 0 )
+        std::cerr << ", " << queue.numFailed.load() << " failed";
+    std::cerr << std::endl;
+
+    return queue.numFailed.load() == 0 ? 0 : 1;
+}
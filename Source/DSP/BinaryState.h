@@ -0,0 +1,265 @@
+/*
+  ==============================================================================
+
+    BinaryState.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_BIG_ENDIAN
+ #error "BinaryState copies values as they're laid out in memory, which assumes little endian"
+#endif
+
+/*
+ The plugin state as a flat little endian blob, read and written without building a ValueTree.
+
+ version 2:
+    uint32  magic ("P13S")
+    uint16  version
+    uint16  number of parameters, then one uint32 per parameter: hashParameterID() of its paramID.
+            this table fixes the parameter order for everything below.
+    uint16  number of parameters again, then one float per parameter: its normalised value
+    uint8   DSP_Order length, then one uint8 per slot: the DSP_Option
+    uint8   number of MIDI learn mappings, then (uint8 controller, uint16 parameter index) each.
+            the index is a position in the table.
+    uint8   number of morph snapshots, then for each one: uint8 slot, and its parameter
+            values and DSP_Order laid out as above.
+
+ version 1 had no table: values and mappings followed AudioProcessor::getParameters() order.
+ parameterIDs is left empty when one is read, and a state without them is written as version 1.
+
+ Parameters are matched by ID, not by position, so the layout can change between versions.
+ Later versions may append fields. Readers ignore bytes they don't know about, and reject
+ versions newer than theirs.
+ */
+struct BinaryState
+{
+    static constexpr juce::uint32 magic = 0x53333150; //"P13S" read as a little endian uint32
+    static constexpr juce::uint16 currentVersion = 2;
+
+    struct MidiMapping
+    {
+        juce::uint8 controller = 0;
+        juce::uint16 parameterIndex = 0;
+    };
+
+    std::vector<juce::uint32> parameterIDs;
+    std::vector<float> parameterValues;
+    std::vector<juce::uint8> dspOrder;
+    std::vector<MidiMapping> midiMappings;
+
+    struct Snapshot
+    {
+        juce::uint8 slot = 0;
+        std::vector<float> parameterValues;
+        std::vector<juce::uint8> dspOrder;
+    };
+
+    std::vector<Snapshot> snapshots;
+
+    /*
+     FNV-1a over the UTF-8 bytes: unlike String::hashCode() it's specified, so it can't change under us.
+     */
+    static juce::uint32 hashParameterID(const juce::String& paramID)
+    {
+        juce::uint32 hash = 2166136261u;
+        for( auto* c = paramID.toRawUTF8(); *c != 0; ++c )
+        {
+            hash ^= static_cast<juce::uint8>(*c);
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    static bool isBinaryState(const void* data, size_t sizeInBytes)
+    {
+        return sizeInBytes >= sizeof(juce::uint32)
+            && juce::ByteOrder::littleEndianInt(data) == magic;
+    }
+
+    void write(juce::MemoryBlock& destData) const
+    {
+        jassert(parameterIDs.size() <= std::numeric_limits<juce::uint16>::max());
+        jassert(parameterIDs.empty() || parameterValues.size() == parameterIDs.size());
+        jassert(dspOrder.size() <= std::numeric_limits<juce::uint8>::max());
+        jassert(midiMappings.size() <= std::numeric_limits<juce::uint8>::max());
+        jassert(snapshots.size() <= std::numeric_limits<juce::uint8>::max());
+
+        destData.setSize(getSizeInBytes());
+        auto* dest = static_cast<char*>(destData.getData());
+
+        auto put = [&dest](auto value)
+        {
+            std::memcpy(dest, &value, sizeof(value));
+            dest += sizeof(value);
+        };
+
+        put(magic);
+        put(getVersion());
+
+        if( getVersion() >= 2 )
+        {
+            put(static_cast<juce::uint16>(parameterIDs.size()));
+            for( auto id : parameterIDs )
+                put(id);
+        }
+
+        auto putValuesAndOrder = [&put](const std::vector<float>& values, const std::vector<juce::uint8>& order)
+        {
+            put(static_cast<juce::uint16>(values.size()));
+            for( auto value : values )
+                put(value);
+
+            put(static_cast<juce::uint8>(order.size()));
+            for( auto option : order )
+                put(option);
+        };
+
+        putValuesAndOrder(parameterValues, dspOrder);
+
+        put(static_cast<juce::uint8>(midiMappings.size()));
+        for( auto& mapping : midiMappings )
+        {
+            put(mapping.controller);
+            put(mapping.parameterIndex);
+        }
+
+        put(static_cast<juce::uint8>(snapshots.size()));
+        for( auto& snapshot : snapshots )
+        {
+            put(snapshot.slot);
+            putValuesAndOrder(snapshot.parameterValues, snapshot.dspOrder);
+        }
+
+        jassert(dest == static_cast<char*>(destData.getData()) + destData.getSize());
+    }
+
+    /*
+     false if the data isn't a BinaryState, is truncated or comes from a newer version.
+     */
+    bool read(const void* data, size_t sizeInBytes)
+    {
+        if( ! isBinaryState(data, sizeInBytes) )
+            return false;
+
+        auto* src = static_cast<const char*>(data);
+        const auto* end = src + sizeInBytes;
+
+        auto get = [&src, end](auto& value)
+        {
+            if( src + sizeof(value) > end )
+                return false;
+
+            std::memcpy(&value, src, sizeof(value));
+            src += sizeof(value);
+            return true;
+        };
+
+        juce::uint32 savedMagic = 0;
+        juce::uint16 version = 0;
+        if( ! get(savedMagic) || ! get(version) || version > currentVersion )
+            return false;
+
+        parameterIDs.clear();
+        if( version >= 2 )
+        {
+            juce::uint16 numIDs = 0;
+            if( ! get(numIDs) )
+                return false;
+
+            parameterIDs.resize(numIDs);
+            for( auto& id : parameterIDs )
+            {
+                if( ! get(id) )
+                    return false;
+            }
+        }
+
+        auto getValuesAndOrder = [this, &get, version](std::vector<float>& values, std::vector<juce::uint8>& order)
+        {
+            juce::uint16 numParameters = 0;
+            if( ! get(numParameters) || (version >= 2 && numParameters != parameterIDs.size()) )
+                return false;
+
+            values.resize(numParameters);
+            for( auto& value : values )
+            {
+                if( ! get(value) )
+                    return false;
+            }
+
+            juce::uint8 orderLength = 0;
+            if( ! get(orderLength) )
+                return false;
+
+            order.resize(orderLength);
+            for( auto& option : order )
+            {
+                if( ! get(option) )
+                    return false;
+            }
+
+            return true;
+        };
+
+        if( ! getValuesAndOrder(parameterValues, dspOrder) )
+            return false;
+
+        juce::uint8 numMappings = 0;
+        if( ! get(numMappings) )
+            return false;
+
+        midiMappings.resize(numMappings);
+        for( auto& mapping : midiMappings )
+        {
+            if( ! get(mapping.controller) || ! get(mapping.parameterIndex) )
+                return false;
+        }
+
+        snapshots.clear();
+        if( src == end )
+            return true;
+
+        juce::uint8 numSnapshots = 0;
+        if( ! get(numSnapshots) )
+            return false;
+
+        snapshots.resize(numSnapshots);
+        for( auto& snapshot : snapshots )
+        {
+            if( ! get(snapshot.slot) || ! getValuesAndOrder(snapshot.parameterValues, snapshot.dspOrder) )
+                return false;
+        }
+
+        return true;
+    }
+private:
+    juce::uint16 getVersion() const { return parameterIDs.empty() ? 1 : currentVersion; }
+
+    size_t getSizeInBytes() const
+    {
+        auto size = sizeof(magic) + sizeof(currentVersion)
+             + (getVersion() >= 2 ? sizeof(juce::uint16) + parameterIDs.size() * sizeof(juce::uint32) : 0)
+             + getSizeInBytes(parameterValues, dspOrder)
+             + sizeof(juce::uint8) + midiMappings.size() * (sizeof(juce::uint8) + sizeof(juce::uint16))
+             + sizeof(juce::uint8) + snapshots.size() * sizeof(juce::uint8);
+
+        for( auto& snapshot : snapshots )
+            size += getSizeInBytes(snapshot.parameterValues, snapshot.dspOrder);
+
+        return size;
+    }
+
+    static size_t getSizeInBytes(const std::vector<float>& values, const std::vector<juce::uint8>& order)
+    {
+        return sizeof(juce::uint16) + values.size() * sizeof(float)
+             + sizeof(juce::uint8) + order.size();
+    }
+};
@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    BlockDelay.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChannelCount.h"
+
+/*
+ Feedback delay that reads and writes its ring buffer in contiguous spans.
+
+ The buffer is a power of 2 long so positions wrap with a mask, and it's allocated
+ once in prepare(). Blocks are processed in chunks no longer than the delay time,
+ so the feedback read for a chunk never overlaps what that chunk writes.
+
+ A change of delay time crossfades from the old read position to the new one over
+ one chunk instead of jumping.
+
+ ping pong (stereo only): the input goes into the left line, and each line feeds back
+ into the other one.
+ */
+struct BlockDelay
+{
+    static constexpr float maxDelayMs = 2000.f;
+    static constexpr float minDelayMs = 1.f;
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        maxBlockSize = static_cast<int>(spec.maximumBlockSize);
+
+        auto maxDelaySamples = static_cast<int>(std::ceil(maxDelayMs * 0.001 * sampleRate));
+        auto capacity = juce::nextPowerOfTwo(maxDelaySamples + maxBlockSize + 1);
+        mask = capacity - 1;
+
+        ringBuffer.setSize(static_cast<int>(spec.numChannels), capacity);
+        delayedBuffer.setSize(static_cast<int>(spec.numChannels), maxBlockSize);
+        fadeBuffer.setSize(static_cast<int>(spec.numChannels), maxBlockSize);
+
+        delaySamples = targetDelaySamples = msToSamples(delayTimeMs);
+        reset();
+    }
+
+    void reset()
+    {
+        ringBuffer.clear();
+        writePosition = 0;
+        delaySamples = targetDelaySamples;
+    }
+
+    void setDelayTimeMs(float newDelayMs)
+    {
+        delayTimeMs = juce::jlimit(minDelayMs, maxDelayMs, newDelayMs);
+
+        if( sampleRate > 0.0 )
+            targetDelaySamples = msToSamples(delayTimeMs);
+    }
+
+    float getDelayTimeMs() const { return delayTimeMs; }
+    float getFeedback() const { return feedback; }
+
+    void setFeedback(float newFeedback) { feedback = juce::jlimit(0.f, 0.95f, newFeedback); }
+    void setMix(float newMix) { mix = juce::jlimit(0.f, 1.f, newMix); }
+    void setPingPong(bool shouldPingPong) { pingPong = shouldPingPong; }
+
+    template<size_t NumChannels = dynamicChannels>
+    void process(const juce::dsp::ProcessContextReplacing<float>& context)
+    {
+        auto& block = context.getOutputBlock();
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+
+        int start = 0;
+        while( start < numSamples )
+        {
+            auto chunkLength = juce::jmin(numSamples - start, maxBlockSize, delaySamples, targetDelaySamples);
+            processChunk<NumChannels>(block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(chunkLength)));
+            start += chunkLength;
+        }
+    }
+private:
+    int msToSamples(float ms) const
+    {
+        auto samples = juce::roundToInt(ms * 0.001 * sampleRate);
+        return juce::jlimit(1, mask + 1 - maxBlockSize, samples);
+    }
+
+    /*
+     copies numSamples from the ring buffer, starting 'delay' samples behind the write position.
+     at most two memcpys: before and after the wrap.
+     */
+    void readDelayed(int channel, int delay, float* destination, int numSamples) const
+    {
+        auto readPosition = (writePosition - delay) & mask;
+        auto firstSpan = juce::jmin(numSamples, mask + 1 - readPosition);
+
+        auto* source = ringBuffer.getReadPointer(channel);
+        juce::FloatVectorOperations::copy(destination, source + readPosition, firstSpan);
+        if( firstSpan < numSamples )
+            juce::FloatVectorOperations::copy(destination + firstSpan, source, numSamples - firstSpan);
+    }
+
+    void writeSpan(int channel, const float* source, int numSamples)
+    {
+        auto firstSpan = juce::jmin(numSamples, mask + 1 - writePosition);
+
+        auto* destination = ringBuffer.getWritePointer(channel);
+        juce::FloatVectorOperations::copy(destination + writePosition, source, firstSpan);
+        if( firstSpan < numSamples )
+            juce::FloatVectorOperations::copy(destination, source + firstSpan, numSamples - firstSpan);
+    }
+
+    template<size_t NumChannels>
+    void processChunk(juce::dsp::AudioBlock<float> block)
+    {
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+        const auto numChannels = juce::jmin(static_cast<int>(getNumChannels<NumChannels>(block)), ringBuffer.getNumChannels());
+
+        for( int ch = 0; ch < numChannels; ++ch )
+        {
+            auto* delayed = delayedBuffer.getWritePointer(ch);
+            readDelayed(ch, delaySamples, delayed, numSamples);
+
+            if( targetDelaySamples != delaySamples )
+            {
+                //fade from the old read position to the new one across this chunk.
+                auto* target = fadeBuffer.getWritePointer(ch);
+                readDelayed(ch, targetDelaySamples, target, numSamples);
+
+                for( int i = 0; i < numSamples; ++i )
+                {
+                    auto gain = static_cast<float>(i + 1) / static_cast<float>(numSamples);
+                    delayed[i] += gain * (target[i] - delayed[i]);
+                }
+            }
+        }
+
+        delaySamples = targetDelaySamples;
+
+        //what goes into the ring buffer: input + feedback. built in fadeBuffer, which is free again.
+        //mono builds don't compile the ping pong path at all.
+        if( NumChannels != 1 && pingPong && numChannels == 2 )
+        {
+            auto* left = fadeBuffer.getWritePointer(0);
+            auto* right = fadeBuffer.getWritePointer(1);
+
+            juce::FloatVectorOperations::add(left, block.getChannelPointer(0), block.getChannelPointer(1), numSamples);
+            juce::FloatVectorOperations::multiply(left, 0.5f, numSamples);
+            juce::FloatVectorOperations::addWithMultiply(left, delayedBuffer.getReadPointer(1), feedback, numSamples);
+
+            juce::FloatVectorOperations::multiply(right, delayedBuffer.getReadPointer(0), feedback, numSamples);
+        }
+        else
+        {
+            for( int ch = 0; ch < numChannels; ++ch )
+            {
+                auto* toWrite = fadeBuffer.getWritePointer(ch);
+                juce::FloatVectorOperations::copy(toWrite, block.getChannelPointer(static_cast<size_t>(ch)), numSamples);
+                juce::FloatVectorOperations::addWithMultiply(toWrite, delayedBuffer.getReadPointer(ch), feedback, numSamples);
+            }
+        }
+
+        for( int ch = 0; ch < numChannels; ++ch )
+        {
+            writeSpan(ch, fadeBuffer.getReadPointer(ch), numSamples);
+
+            //out = dry * (1 - mix) + delayed * mix
+            auto* out = block.getChannelPointer(static_cast<size_t>(ch));
+            juce::FloatVectorOperations::multiply(out, 1.f - mix, numSamples);
+            juce::FloatVectorOperations::addWithMultiply(out, delayedBuffer.getReadPointer(ch), mix, numSamples);
+        }
+
+        writePosition = (writePosition + numSamples) & mask;
+    }
+
+    double sampleRate = 0.0;
+    int maxBlockSize = 0;
+    int mask = 0;
+    int writePosition = 0;
+
+    float delayTimeMs = 250.f;
+    int delaySamples = 1;
+    int targetDelaySamples = 1;
+
+    float feedback = 0.f;
+    float mix = 0.f;
+    bool pingPong = false;
+
+    juce::AudioBuffer<float> ringBuffer, delayedBuffer, fadeBuffer;
+};
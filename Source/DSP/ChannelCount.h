@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    ChannelCount.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ The chain's kernels take the channel count as a template parameter:
+ 1 or 2 when it's known at compile time, dynamicChannels when it's only known at run time.
+ With a fixed count the per-channel loops unroll and mono never touches a second channel.
+ */
+constexpr size_t dynamicChannels = 0;
+
+template<size_t NumChannels>
+size_t getNumChannels(const juce::dsp::AudioBlock<float>& block)
+{
+    if constexpr ( NumChannels == dynamicChannels )
+    {
+        return block.getNumChannels();
+    }
+    else
+    {
+        jassert(block.getNumChannels() == NumChannels);
+        return NumChannels;
+    }
+}
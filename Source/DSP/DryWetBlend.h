@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    DryWetBlend.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChannelCount.h"
+
+/*
+ Blends a dry block into the wet one in place: wet = dry + gain * (wet - dry).
+
+ The wet gain is smoothed. A steady gain is two FloatVectorOperations passes per
+ channel. While it ramps, the gains are written out once and every channel is blended
+ with vector subtract/multiply/add against them.
+
+ The caller supplies the dry block, already aligned with any latency of the wet path.
+ */
+struct DryWetBlend
+{
+    void prepare(double sampleRate, int maxBlockSize, double rampLengthSeconds = 0.01)
+    {
+        wetGain.reset(sampleRate, rampLengthSeconds);
+        gainRamp.resize(static_cast<size_t>(maxBlockSize));
+    }
+
+    void setWetGain(float newGain) { wetGain.setTargetValue(newGain); }
+    void setCurrentAndTargetWetGain(float newGain) { wetGain.setCurrentAndTargetValue(newGain); }
+
+    float getTargetWetGain() const { return wetGain.getTargetValue(); }
+    float getCurrentWetGain() const { return wetGain.getCurrentValue(); }
+    bool isSmoothing() const { return wetGain.isSmoothing(); }
+
+    //the ramp can only be written out for blocks up to the prepared size.
+    bool canProcess(size_t numSamples) const { return numSamples <= gainRamp.size(); }
+
+    void finishRamp() { wetGain.setCurrentAndTargetValue(wetGain.getTargetValue()); }
+
+    template<size_t NumChannels = dynamicChannels>
+    void process(const juce::dsp::AudioBlock<float>& wet, const juce::dsp::AudioBlock<float>& dry)
+    {
+        const auto numSamples = static_cast<int>(wet.getNumSamples());
+        const auto numChannels = juce::jmin(getNumChannels<NumChannels>(wet), dry.getNumChannels());
+
+        if( ! wetGain.isSmoothing() )
+        {
+            const auto gain = wetGain.getTargetValue();
+            for( size_t ch = 0; ch < numChannels; ++ch )
+            {
+                auto* w = wet.getChannelPointer(ch);
+                juce::FloatVectorOperations::multiply(w, gain, numSamples);
+                juce::FloatVectorOperations::addWithMultiply(w, dry.getChannelPointer(ch), 1.f - gain, numSamples);
+            }
+
+            return;
+        }
+
+        jassert(canProcess(wet.getNumSamples()));
+
+        for( int i = 0; i < numSamples; ++i )
+            gainRamp[static_cast<size_t>(i)] = wetGain.getNextValue();
+
+        for( size_t ch = 0; ch < numChannels; ++ch )
+        {
+            auto* w = wet.getChannelPointer(ch);
+            auto* d = dry.getChannelPointer(ch);
+            juce::FloatVectorOperations::subtract(w, d, numSamples);
+            juce::FloatVectorOperations::multiply(w, gainRamp.data(), numSamples);
+            juce::FloatVectorOperations::add(w, d, numSamples);
+        }
+    }
+private:
+    juce::SmoothedValue<float> wetGain { 1.f };
+    std::vector<float> gainRamp;
+};
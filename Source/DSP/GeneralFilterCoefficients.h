@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    GeneralFilterCoefficients.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../SimpleMultiBandComp/Source/DSP/Fifo.h"
+
+#include <map>
+
+enum class GeneralFilterMode
+{
+    Peak,
+    BandPass,
+    Notch,
+    AllPass,
+};
+
+struct GeneralFilterParams
+{
+    GeneralFilterMode mode = GeneralFilterMode::Peak;
+    float frequency = 750.f;
+    float quality = 1.f;
+    float gain = 0.f;
+    double sampleRate = 44100.0;
+};
+
+/*
+ Builds General Filter coefficients off the audio thread.
+
+ The audio thread pushes GeneralFilterParams into paramsFifo whenever a General Filter
+ parameter moves. This thread pulls the most recent ones, looks them up in a cache keyed
+ on the parameter grid (1 Hz / 0.05 Q / 0.5 dB) and pushes the resulting Coefficients::Ptr
+ into coefficientsFifo.
+
+ Every Ptr handed to the audio thread is also owned by the cache or the release pool, so
+ the audio thread never drops the last reference and never deletes coefficients.
+
+ The first coefficients after prepareToPlay(), and all of them when rendering offline, are
+ made on the calling thread instead: the filter never waits for this one, so renders are
+ the same every time.
+ */
+struct FilterCoefficientGenerator : juce::Thread
+{
+    using Coefficients = juce::dsp::IIR::Coefficients<float>;
+    using ParamsFifo = SimpleMBComp::Fifo<GeneralFilterParams>;
+    using CoefficientsFifo = SimpleMBComp::Fifo<Coefficients::Ptr>;
+
+    static constexpr float frequencyStep = 1.f;
+    static constexpr float qualityStep = 0.05f;
+    static constexpr float gainStep = 0.5f;
+    static constexpr size_t maxCacheSize = 4096;
+
+    FilterCoefficientGenerator(ParamsFifo& params, CoefficientsFifo& coefficients) :
+        juce::Thread("General Filter Coefficients"),
+        paramsFifo(params),
+        coefficientsFifo(coefficients)
+    {
+        startThread();
+    }
+
+    ~FilterCoefficientGenerator() override
+    {
+        stopThread(500);
+    }
+
+    void run() override
+    {
+        while( ! threadShouldExit() )
+        {
+            GeneralFilterParams params;
+            bool pulled = false;
+
+            //only the most recent params matter
+            while( paramsFifo.pull(params) )
+            {
+                pulled = true;
+            }
+
+            if( pulled )
+            {
+                coefficientsFifo.push( getCoefficients(params) );
+            }
+
+            releaseUnusedCoefficients();
+
+            //polling, so the audio thread never has to signal (and lock) anything.
+            wait(5);
+        }
+    }
+
+    /*
+     quantises the params to the parameter grid and either returns the cached coefficients
+     or makes and caches new ones.
+     */
+    Coefficients::Ptr getCoefficients(const GeneralFilterParams& params)
+    {
+        CacheKey key
+        {
+            static_cast<int>(params.mode),
+            juce::roundToInt(params.frequency / frequencyStep),
+            juce::roundToInt(params.quality / qualityStep),
+            juce::roundToInt(params.gain / gainStep),
+            juce::roundToInt(params.sampleRate),
+        };
+
+        if( auto it = cache.find(key); it != cache.end() )
+            return it->second;
+
+        if( cache.size() >= maxCacheSize )
+        {
+            for( auto& [k, coefficients] : cache )
+                releasePool.push_back(coefficients);
+
+            cache.clear();
+        }
+
+        auto quantised = params;
+        quantised.frequency = static_cast<float>(key.frequency) * frequencyStep;
+        quantised.quality = static_cast<float>(key.quality) * qualityStep;
+        quantised.gain = static_cast<float>(key.gain) * gainStep;
+
+        auto coefficients = makeCoefficients(quantised);
+        cache.emplace(key, coefficients);
+        return coefficients;
+    }
+
+    static Coefficients::Ptr makeCoefficients(const GeneralFilterParams& params)
+    {
+        Coefficients::Ptr coefficients = new Coefficients(1.f, 0.f, 0.f, 1.f, 0.f, 0.f);
+        makeCoefficients(params, *coefficients);
+        return coefficients;
+    }
+
+    /*
+     writes the coefficients for params into an existing biquad without allocating, so
+     prepareToPlay() and offline renders can have them straight away instead of waiting for this thread.
+     the values are the same as the ones run() hands over for the same params.
+     */
+    static void makeCoefficients(const GeneralFilterParams& params, Coefficients& coefficients)
+    {
+        using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<float>;
+
+        auto frequency = juce::jlimit(1.f, static_cast<float>(params.sampleRate * 0.499), params.frequency);
+        auto quality = juce::jmax(0.01f, params.quality);
+
+        std::array<float, 6> raw { 1.f, 0.f, 0.f, 1.f, 0.f, 0.f };
+        switch (params.mode)
+        {
+            case GeneralFilterMode::Peak:
+                raw = ArrayCoefficients::makePeakFilter(params.sampleRate, frequency, quality, juce::Decibels::decibelsToGain(params.gain));
+                break;
+            case GeneralFilterMode::BandPass:
+                raw = ArrayCoefficients::makeBandPass(params.sampleRate, frequency, quality);
+                break;
+            case GeneralFilterMode::Notch:
+                raw = ArrayCoefficients::makeNotch(params.sampleRate, frequency, quality);
+                break;
+            case GeneralFilterMode::AllPass:
+                raw = ArrayCoefficients::makeAllPass(params.sampleRate, frequency, quality);
+                break;
+        }
+
+        //b0, b1, b2, a1, a2 divided by a0, the way the Coefficients constructor stores them.
+        jassert(coefficients.coefficients.size() == 5);
+        if( coefficients.coefficients.size() != 5 )
+            return;
+
+        const auto a0Inv = 1.f / raw[3];
+        auto* c = coefficients.getRawCoefficients();
+        c[0] = raw[0] * a0Inv;
+        c[1] = raw[1] * a0Inv;
+        c[2] = raw[2] * a0Inv;
+        c[3] = raw[4] * a0Inv;
+        c[4] = raw[5] * a0Inv;
+    }
+private:
+    struct CacheKey
+    {
+        int mode, frequency, quality, gain, sampleRate;
+        auto operator<=>(const CacheKey&) const = default;
+    };
+
+    /*
+     evicted coefficients may still be sitting in a fifo slot or be in use on the audio
+     thread. They are only released once this pool holds the last reference.
+     */
+    void releaseUnusedCoefficients()
+    {
+        releasePool.erase(std::remove_if(releasePool.begin(),
+                                         releasePool.end(),
+                                         [](const Coefficients::Ptr& c)
+                                         {
+                                             return c->getReferenceCount() <= 1;
+                                         }),
+                          releasePool.end());
+    }
+
+    ParamsFifo& paramsFifo;
+    CoefficientsFifo& coefficientsFifo;
+
+    std::map<CacheKey, Coefficients::Ptr> cache;
+    std::vector<Coefficients::Ptr> releasePool;
+};
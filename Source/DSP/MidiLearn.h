@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    MidiLearn.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ MIDI CC -> parameter mappings, on any channel.
+ Parameters are identified by their index in AudioProcessor::getParameters().
+
+ The message thread arms learning for a parameter. The next CC the audio thread sees is
+ then mapped to it, replacing any other mapping of that parameter. Every mapping is an
+ atomic, so neither side ever waits for the other.
+ */
+struct MidiLearn
+{
+    static constexpr int numControllers = 128;
+    static constexpr int notMapped = -1;
+
+    MidiLearn()
+    {
+        clearAll();
+    }
+
+    //==============================================================================
+    //message thread
+
+    void startLearning(int parameterIndex) { learningParameter.store(parameterIndex); }
+    void stopLearning() { learningParameter.store(notMapped); }
+    int getLearningParameter() const { return learningParameter.load(); }
+
+    void setMapping(int controller, int parameterIndex)
+    {
+        jassert(juce::isPositiveAndBelow(controller, numControllers));
+        clearMappingsFor(parameterIndex);
+        mappings[static_cast<size_t>(controller)].store(parameterIndex);
+    }
+
+    void clearMappingsFor(int parameterIndex)
+    {
+        for( auto& mapping : mappings )
+        {
+            auto expected = parameterIndex;
+            mapping.compare_exchange_strong(expected, notMapped);
+        }
+    }
+
+    void clearAll()
+    {
+        for( auto& mapping : mappings )
+            mapping.store(notMapped);
+    }
+
+    //the controller mapped to parameterIndex, or notMapped.
+    int getControllerFor(int parameterIndex) const
+    {
+        for( size_t controller = 0; controller < mappings.size(); ++controller )
+        {
+            if( mappings[controller].load() == parameterIndex )
+                return static_cast<int>(controller);
+        }
+
+        return notMapped;
+    }
+
+    int getParameterFor(int controller) const
+    {
+        return mappings[static_cast<size_t>(controller)].load();
+    }
+
+    //==============================================================================
+    //audio thread
+
+    /*
+     the parameter this controller moves, or notMapped. learns the controller first if learning is armed.
+     */
+    int handleController(int controller)
+    {
+        jassert(juce::isPositiveAndBelow(controller, numControllers));
+
+        if( auto learning = learningParameter.exchange(notMapped); learning != notMapped )
+            setMapping(controller, learning);
+
+        return getParameterFor(controller);
+    }
+private:
+    std::array<std::atomic<int>, numControllers> mappings;
+    std::atomic<int> learningParameter { notMapped };
+};
@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+    Modulation.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ Control rate modulators. Each one is advanced once per control interval and holds its
+ value for that interval: the DSPs' own parameter smoothing interpolates between them.
+ */
+
+enum class LFOShape
+{
+    Sine,
+    Triangle,
+    Saw,
+    Square,
+};
+
+/*
+ bipolar, -1 to 1
+ */
+struct LFO
+{
+    void prepare(double newSampleRate) { sampleRate = newSampleRate; reset(); }
+    void reset() { phase = 0.0; }
+
+    void setRateHz(float newRate) { rateHz = newRate; }
+    void setShape(LFOShape newShape) { shape = newShape; }
+
+    float getValue() const
+    {
+        auto p = static_cast<float>(phase);
+        switch (shape)
+        {
+            case LFOShape::Sine:
+                return std::sin(p * juce::MathConstants<float>::twoPi);
+            case LFOShape::Triangle:
+                return 1.f - 4.f * std::abs(p - 0.5f);
+            case LFOShape::Saw:
+                return 2.f * p - 1.f;
+            case LFOShape::Square:
+                return p < 0.5f ? 1.f : -1.f;
+        }
+
+        return 0.f;
+    }
+
+    void advance(int numSamples)
+    {
+        phase += static_cast<double>(rateHz) * numSamples / sampleRate;
+        phase -= std::floor(phase);
+    }
+private:
+    double sampleRate = 44100.0;
+    double phase = 0.0;
+    float rateHz = 1.f;
+    LFOShape shape = LFOShape::Sine;
+};
+
+/*
+ peak follower on the chain's input. unipolar, 0 to 1.
+ */
+struct EnvelopeFollower
+{
+    void prepare(double newSampleRate) { sampleRate = newSampleRate; reset(); }
+    void reset() { envelope = 0.f; }
+
+    void setAttackMs(float newAttack) { attackMs = newAttack; }
+    void setReleaseMs(float newRelease) { releaseMs = newRelease; }
+
+    float getValue() const { return juce::jmin(envelope, 1.f); }
+
+    void process(const juce::dsp::AudioBlock<float>& block)
+    {
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+        if( numSamples == 0 )
+            return;
+
+        float peak = 0.f;
+        for( size_t ch = 0; ch < block.getNumChannels(); ++ch )
+        {
+            auto range = juce::FloatVectorOperations::findMinAndMax(block.getChannelPointer(ch), numSamples);
+            peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+        }
+
+        //one pole per control interval rather than per sample.
+        auto timeMs = peak > envelope ? attackMs : releaseMs;
+        auto coefficient = std::exp(-static_cast<float>(numSamples) / (timeMs * 0.001f * static_cast<float>(sampleRate)));
+        envelope = peak + coefficient * (envelope - peak);
+    }
+private:
+    double sampleRate = 44100.0;
+    float envelope = 0.f;
+    float attackMs = 10.f;
+    float releaseMs = 200.f;
+};
+
+/*
+ numSteps values, -1 to 1, stepped through at rateHz steps per second.
+ */
+struct StepSequencer
+{
+    static constexpr int numSteps = 8;
+
+    void prepare(double newSampleRate) { sampleRate = newSampleRate; reset(); }
+    void reset() { position = 0.0; }
+
+    void setRateHz(float newRate) { rateHz = newRate; }
+    void setStep(int step, float value) { steps[static_cast<size_t>(step)] = value; }
+
+    float getValue() const { return steps[static_cast<size_t>(position) % steps.size()]; }
+
+    void advance(int numSamples)
+    {
+        position += static_cast<double>(rateHz) * numSamples / sampleRate;
+        position = std::fmod(position, static_cast<double>(numSteps));
+    }
+private:
+    double sampleRate = 44100.0;
+    double position = 0.0;
+    float rateHz = 4.f;
+    std::array<float, numSteps> steps {};
+};
+
+enum class ModulationSource
+{
+    None,
+    LFO1,
+    LFO2,
+    Envelope,
+    StepSequencer,
+};
+
+/*
+ The matrix: each slot adds depth * source to its target, in the target's normalised range.
+ update() runs once per control interval and collects the active slots, so looking up a
+ parameter's modulated value is a scan of at most numSlots entries.
+ */
+struct ModulationMatrix
+{
+    static constexpr size_t numSlots = 4;
+
+    struct Slot
+    {
+        ModulationSource source = ModulationSource::None;
+        juce::AudioParameterFloat* target = nullptr;
+        float depth = 0.f;
+    };
+
+    void prepare(double sampleRate)
+    {
+        for( auto& lfo : lfos )
+            lfo.prepare(sampleRate);
+
+        envelope.prepare(sampleRate);
+        stepSequencer.prepare(sampleRate);
+        numActive = 0;
+    }
+
+    /*
+     call at the start of each control interval, numSamples long.
+     the envelope follower is fed separately, with the chain's input as it arrives.
+     */
+    void update(const std::array<Slot, numSlots>& slots, int numSamples)
+    {
+        numActive = 0;
+        for( auto& slot : slots )
+        {
+            if( slot.source == ModulationSource::None || slot.target == nullptr || slot.depth == 0.f )
+                continue;
+
+            active[numActive++] = { slot.target, slot.depth * getSourceValue(slot.source) };
+        }
+
+        for( auto& lfo : lfos )
+            lfo.advance(numSamples);
+
+        stepSequencer.advance(numSamples);
+    }
+
+    bool isModulating(const juce::AudioParameterFloat* parameter) const
+    {
+        for( size_t i = 0; i < numActive; ++i )
+        {
+            if( active[i].target == parameter )
+                return true;
+        }
+
+        return false;
+    }
+
+    bool isActive() const { return numActive > 0; }
+
+    /*
+     the parameter's value with this interval's modulation applied, clamped to its range.
+     */
+    float getModulatedValue(const juce::AudioParameterFloat* parameter) const
+    {
+        auto value = parameter->get();
+
+        float offset = 0.f;
+        bool modulated = false;
+        for( size_t i = 0; i < numActive; ++i )
+        {
+            if( active[i].target == parameter )
+            {
+                offset += active[i].offset;
+                modulated = true;
+            }
+        }
+
+        if( ! modulated )
+            return value;
+
+        auto normalised = juce::jlimit(0.f, 1.f, parameter->range.convertTo0to1(value) + offset);
+        return parameter->range.convertFrom0to1(normalised);
+    }
+
+    std::array<LFO, 2> lfos;
+    EnvelopeFollower envelope;
+    StepSequencer stepSequencer;
+private:
+    float getSourceValue(ModulationSource source) const
+    {
+        switch (source)
+        {
+            case ModulationSource::None:
+                return 0.f;
+            case ModulationSource::LFO1:
+                return lfos[0].getValue();
+            case ModulationSource::LFO2:
+                return lfos[1].getValue();
+            case ModulationSource::Envelope:
+                return envelope.getValue();
+            case ModulationSource::StepSequencer:
+                return stepSequencer.getValue();
+        }
+
+        return 0.f;
+    }
+
+    struct ActiveModulation
+    {
+        const juce::AudioParameterFloat* target = nullptr;
+        float offset = 0.f;
+    };
+
+    std::array<ActiveModulation, numSlots> active;
+    size_t numActive = 0;
+};
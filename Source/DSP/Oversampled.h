@@ -0,0 +1,380 @@
+/*
+  ==============================================================================
+
+    Oversampled.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChannelCount.h"
+
+enum class OversamplingFilter
+{
+    PolyphaseIIR,
+    LinearPhaseFIR,
+};
+
+/*
+ A fixed delay for whole blocks: a power of 2 ring buffer that blocks are copied into and
+ out of in at most two spans per channel.
+ */
+struct CompensationDelay
+{
+    void prepare(int numChannels, int maxDelaySamples, int maxBlockSize)
+    {
+        maxChunkSize = juce::jmax(1, maxBlockSize);
+        auto capacity = juce::nextPowerOfTwo(maxDelaySamples + maxChunkSize + 1);
+        mask = capacity - 1;
+
+        ringBuffer.setSize(numChannels, capacity);
+        reset();
+    }
+
+    void reset()
+    {
+        ringBuffer.clear();
+        writePosition = 0;
+    }
+
+    void setDelay(int newDelaySamples) { delaySamples = newDelaySamples; }
+
+    //remembers the block, so it can be read back once it's delaySamples old.
+    void write(const juce::dsp::AudioBlock<float>& block)
+    {
+        forEachChunk(block, [this](const juce::dsp::AudioBlock<float>& chunk) { writeChunk(chunk); });
+    }
+
+    //'block' delayed by delaySamples, in place.
+    void process(juce::dsp::AudioBlock<float>& block)
+    {
+        forEachChunk(block, [this](juce::dsp::AudioBlock<float>& chunk)
+        {
+            writeChunk(chunk);
+            const auto numSamples = static_cast<int>(chunk.getNumSamples());
+            copySpans(chunk, writePosition - numSamples - delaySamples, [this, &chunk](int ch, int ringStart, int chunkStart, int length)
+            {
+                juce::FloatVectorOperations::copy(chunk.getChannelPointer(static_cast<size_t>(ch)) + chunkStart, ringBuffer.getReadPointer(ch, ringStart), length);
+            });
+        });
+    }
+private:
+    template<typename Block, typename ProcessChunk>
+    void forEachChunk(Block& block, ProcessChunk&& processChunk)
+    {
+        const auto numSamples = block.getNumSamples();
+        for( size_t start = 0; start < numSamples; start += static_cast<size_t>(maxChunkSize) )
+        {
+            auto chunk = block.getSubBlock(start, juce::jmin(static_cast<size_t>(maxChunkSize), numSamples - start));
+            processChunk(chunk);
+        }
+    }
+
+    void writeChunk(const juce::dsp::AudioBlock<float>& chunk)
+    {
+        const auto numSamples = static_cast<int>(chunk.getNumSamples());
+        copySpans(chunk, writePosition, [this, &chunk](int ch, int ringStart, int chunkStart, int length)
+        {
+            juce::FloatVectorOperations::copy(ringBuffer.getWritePointer(ch, ringStart), chunk.getChannelPointer(static_cast<size_t>(ch)) + chunkStart, length);
+        });
+
+        writePosition = (writePosition + numSamples) & mask;
+    }
+
+    //calls copy(channel, ring position, chunk position, length) for the one or two spans of the ring the chunk maps to from 'ringPosition'.
+    template<typename Copy>
+    void copySpans(const juce::dsp::AudioBlock<float>& chunk, int ringPosition, Copy&& copy) const
+    {
+        const auto numSamples = static_cast<int>(chunk.getNumSamples());
+        const auto start = ringPosition & mask;
+        const auto firstLength = juce::jmin(numSamples, mask + 1 - start);
+        const auto numChannels = juce::jmin(static_cast<int>(chunk.getNumChannels()), ringBuffer.getNumChannels());
+
+        for( int ch = 0; ch < numChannels; ++ch )
+        {
+            copy(ch, start, 0, firstLength);
+            if( firstLength < numSamples )
+                copy(ch, 0, firstLength, numSamples - firstLength);
+        }
+    }
+
+    juce::AudioBuffer<float> ringBuffer;
+    int mask = 0;
+    int writePosition = 0;
+    int delaySamples = 0;
+    int maxChunkSize = 1;
+};
+
+/*
+ Runs DSP at 1x, 2x, 4x or 8x the host rate.
+
+ Every factor/filter combination is allocated in prepare(), and DSP is prepared for the
+ largest block the highest factor can hand it, so switching on the audio thread only
+ changes DSP's sample rate. The oversamplers use integer latency so it can be reported
+ to the host exactly.
+
+ A switch fades the output out, changes the factor at silence and fades back in: the
+ old and new factors share DSP, so they can't be crossfaded.
+
+ processBypassed() delays the signal by the same latency, so bypassing the module
+ doesn't shift the rest of the chain. The compensation delay hears the input whichever
+ way the block goes, so it's never holding stale audio when bypass starts.
+ */
+template<typename DSP>
+struct Oversampled : DSP
+{
+    static constexpr size_t maxFactorLog2 = 3;
+    static constexpr size_t numFilterTypes = 2;
+    static constexpr double switchFadeSeconds = 0.005;
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        baseSpec = spec;
+
+        maxLatency = 0;
+        for( size_t filter = 0; filter < numFilterTypes; ++filter )
+        {
+            for( size_t factor = 1; factor <= maxFactorLog2; ++factor )
+            {
+                auto type = filter == static_cast<size_t>(OversamplingFilter::PolyphaseIIR) ?
+                                juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR :
+                                juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple;
+
+                auto& oversampler = oversamplers[filter][factor - 1];
+                oversampler = std::make_unique<juce::dsp::Oversampling<float>>(spec.numChannels, factor, type, true, true);
+                oversampler->initProcessing(spec.maximumBlockSize);
+
+                maxLatency = juce::jmax(maxLatency, juce::roundToInt(oversampler->getLatencyInSamples()));
+            }
+        }
+
+        compensationDelay.prepare(static_cast<int>(spec.numChannels), maxLatency, static_cast<int>(spec.maximumBlockSize));
+
+        auto maxSpec = spec;
+        maxSpec.sampleRate *= static_cast<double>(1 << maxFactorLog2);
+        maxSpec.maximumBlockSize *= static_cast<juce::uint32>(1 << maxFactorLog2);
+        DSP::prepare(maxSpec);
+
+        switchFadeSamples = juce::jmax(1, juce::roundToInt(spec.sampleRate * switchFadeSeconds));
+        switchFadePosition = switchFadeSamples;
+        switchPending = false;
+
+        applyOversampling();
+    }
+
+    /*
+     factorLog2: 0 = 1x, 1 = 2x, 2 = 4x, 3 = 8x
+     */
+    void setOversampling(size_t newFactorLog2, OversamplingFilter newFilter)
+    {
+        newFactorLog2 = juce::jmin(newFactorLog2, maxFactorLog2);
+        if( newFactorLog2 == targetFactorLog2 && newFilter == targetFilter )
+            return;
+
+        targetFactorLog2 = newFactorLog2;
+        targetFilter = newFilter;
+
+        //not prepared yet. prepare() will apply it.
+        if( baseSpec.sampleRate <= 0.0 )
+            return;
+
+        //at 1x the filter isn't used, so there's nothing to fade.
+        if( targetFactorLog2 == 0 && factorLog2 == 0 )
+        {
+            filter = targetFilter;
+            switchPending = false;
+            return;
+        }
+
+        //going back to the active setting mid fade just fades back in.
+        switchPending = targetFactorLog2 != factorLog2 || targetFilter != filter;
+    }
+
+    //the active factor's latency. a pending switch changes it once the fade out is done.
+    int getLatencyInSamples() const { return latency; }
+    //the largest latency any factor/filter combination can have at the prepared rate.
+    int getMaxLatencyInSamples() const { return maxLatency; }
+
+    template<size_t NumChannels = dynamicChannels>
+    void process(const juce::dsp::ProcessContextReplacing<float>& context)
+    {
+        auto block = context.getOutputBlock();
+        //its output isn't needed. it's only keeping up with the input for processBypassed().
+        compensationDelay.write(block);
+
+        processSwitching(block, nullptr, [this](juce::dsp::AudioBlock<float>& segment, juce::dsp::AudioBlock<float>*)
+        {
+            processOversampled<NumChannels>(segment);
+        });
+    }
+
+    void processBypassed(const juce::dsp::ProcessContextReplacing<float>& context)
+    {
+        auto block = context.getOutputBlock();
+
+        processSwitching(block, nullptr, [this](juce::dsp::AudioBlock<float>& segment, juce::dsp::AudioBlock<float>*)
+        {
+            compensationDelay.process(segment);
+        });
+    }
+
+    /*
+     process() on 'context' and processBypassed() on 'dryContext', for a blend of the two:
+     the compensation delay and the switch fade only move once for both.
+     */
+    template<size_t NumChannels = dynamicChannels>
+    void processWithDry(const juce::dsp::ProcessContextReplacing<float>& context, const juce::dsp::ProcessContextReplacing<float>& dryContext)
+    {
+        auto block = context.getOutputBlock();
+        auto dry = dryContext.getOutputBlock();
+        jassert( dry.getNumSamples() == block.getNumSamples() );
+
+        processSwitching(block, &dry, [this](juce::dsp::AudioBlock<float>& segment, juce::dsp::AudioBlock<float>* drySegment)
+        {
+            compensationDelay.process(*drySegment);
+            processOversampled<NumChannels>(segment);
+        });
+    }
+
+    /*
+     the compensation delay is left alone: it's fed every block, so it always has the latest input.
+     */
+    void reset()
+    {
+        DSP::reset();
+
+        if( active != nullptr )
+            active->reset();
+    }
+private:
+    //DSPs that have a fixed channel count version of process() get it.
+    template<size_t NumChannels>
+    void processDSP(const juce::dsp::ProcessContextReplacing<float>& context)
+    {
+        if constexpr ( NumChannels != dynamicChannels && requires { DSP::template process<NumChannels>(context); } )
+            DSP::template process<NumChannels>(context);
+        else
+            DSP::process(context);
+    }
+
+    template<size_t NumChannels>
+    void processOversampled(juce::dsp::AudioBlock<float>& block)
+    {
+        if( active == nullptr )
+        {
+            processDSP<NumChannels>(juce::dsp::ProcessContextReplacing<float>(block));
+            return;
+        }
+
+        const auto maxBlockSize = static_cast<size_t>(baseSpec.maximumBlockSize);
+
+        //the oversamplers were sized for maximumBlockSize, so larger host blocks are split.
+        for( size_t start = 0; start < block.getNumSamples(); start += maxBlockSize )
+        {
+            auto subBlock = block.getSubBlock(start, juce::jmin(maxBlockSize, block.getNumSamples() - start));
+
+            auto upBlock = active->processSamplesUp(subBlock);
+            auto upContext = juce::dsp::ProcessContextReplacing<float>(upBlock);
+            processDSP<NumChannels>(upContext);
+            active->processSamplesDown(subBlock);
+        }
+    }
+
+    /*
+     runs processSegment on the part of the block before a pending switch and on the part after it,
+     fading the segments (and their dry counterparts) out before the switch and back in after it.
+     */
+    template<typename ProcessSegment>
+    void processSwitching(juce::dsp::AudioBlock<float>& block, juce::dsp::AudioBlock<float>* dry, ProcessSegment&& processSegment)
+    {
+        const auto numSamples = block.getNumSamples();
+        size_t start = 0;
+
+        if( switchPending )
+        {
+            const auto numFadeSamples = juce::jmin(numSamples, static_cast<size_t>(switchFadePosition));
+            if( numFadeSamples > 0 )
+                processFadingSegment(block, dry, 0, numFadeSamples, -1, processSegment);
+
+            start = numFadeSamples;
+            if( switchFadePosition == 0 )
+            {
+                applyOversampling();
+                switchPending = false;
+            }
+        }
+
+        if( start < numSamples )
+            processFadingSegment(block, dry, start, numSamples - start, 1, processSegment);
+    }
+
+    template<typename ProcessSegment>
+    void processFadingSegment(juce::dsp::AudioBlock<float>& block, juce::dsp::AudioBlock<float>* dry, size_t start, size_t length, int direction, ProcessSegment& processSegment)
+    {
+        auto segment = block.getSubBlock(start, length);
+        auto drySegment = dry != nullptr ? dry->getSubBlock(start, length) : juce::dsp::AudioBlock<float>();
+        processSegment(segment, dry != nullptr ? &drySegment : nullptr);
+
+        //fully faded in: nothing to do.
+        if( direction > 0 && switchFadePosition == switchFadeSamples )
+            return;
+
+        for( size_t i = 0; i < length; ++i )
+        {
+            switchFadePosition = juce::jlimit(0, switchFadeSamples, switchFadePosition + direction);
+            const auto gain = static_cast<float>(switchFadePosition) / static_cast<float>(switchFadeSamples);
+
+            for( size_t ch = 0; ch < segment.getNumChannels(); ++ch )
+                segment.getChannelPointer(ch)[i] *= gain;
+
+            if( dry != nullptr )
+            {
+                for( size_t ch = 0; ch < drySegment.getNumChannels(); ++ch )
+                    drySegment.getChannelPointer(ch)[i] *= gain;
+            }
+        }
+    }
+
+    void applyOversampling()
+    {
+        factorLog2 = targetFactorLog2;
+        filter = targetFilter;
+        active = factorLog2 == 0 ? nullptr : oversamplers[static_cast<size_t>(filter)][factorLog2 - 1].get();
+
+        if( active != nullptr )
+            active->reset();
+
+        auto spec = baseSpec;
+        spec.sampleRate *= static_cast<double>(1 << factorLog2);
+        spec.maximumBlockSize *= static_cast<juce::uint32>(1 << factorLog2);
+
+        //DSPs with buffers have a rate-only prepare that keeps them. the rest don't allocate when the channel count is unchanged.
+        if constexpr ( requires { DSP::prepareSampleRate(spec.sampleRate); } )
+            DSP::prepareSampleRate(spec.sampleRate);
+        else
+            DSP::prepare(spec);
+
+        latency = active == nullptr ? 0 : juce::roundToInt(active->getLatencyInSamples());
+        compensationDelay.setDelay(latency);
+    }
+
+    juce::dsp::ProcessSpec baseSpec { 0.0, 0, 0 };
+    size_t factorLog2 = 0, targetFactorLog2 = 0;
+    OversamplingFilter filter = OversamplingFilter::PolyphaseIIR, targetFilter = OversamplingFilter::PolyphaseIIR;
+    int latency = 0;
+    int maxLatency = 0;
+
+    //switchFadePosition / switchFadeSamples is the output's gain.
+    int switchFadeSamples = 1;
+    int switchFadePosition = 1;
+    bool switchPending = false;
+
+    std::array<std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, maxFactorLog2>, numFilterTypes> oversamplers;
+    juce::dsp::Oversampling<float>* active = nullptr;
+
+    CompensationDelay compensationDelay;
+};
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BinaryState.h"
+
+/*
+ A bank of named presets in one file, each one a BinaryState.
+
+ version 1:
+    uint32  magic ("P13B")
+    uint16  version
+    uint16  number of presets, then for each one:
+        uint8   name length, then the name as UTF-8
+        uint32  state size, then the BinaryState
+
+ The file is memory mapped and walked once. The processor copies what it needs into its
+ own table, so nothing is kept open.
+ */
+struct PresetBank
+{
+    static constexpr juce::uint32 magic = 0x42333150; //"P13B" read as a little endian uint32
+    static constexpr juce::uint16 currentVersion = 1;
+
+    struct Preset
+    {
+        juce::String name;
+        juce::MemoryBlock state;
+    };
+
+    /*
+     calls onPreset(name, state) for every preset in the file.
+     false if the file can't be mapped or isn't a bank. presets before any damage are still delivered.
+     */
+    template<typename OnPreset>
+    static bool load(const juce::File& file, OnPreset&& onPreset)
+    {
+        juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+        if( mapped.getData() == nullptr )
+            return false;
+
+        auto* src = static_cast<const char*>(mapped.getData());
+        const auto* end = src + mapped.getSize();
+
+        auto get = [&src, end](auto& value)
+        {
+            if( src + sizeof(value) > end )
+                return false;
+
+            std::memcpy(&value, src, sizeof(value));
+            src += sizeof(value);
+            return true;
+        };
+
+        juce::uint32 savedMagic = 0;
+        juce::uint16 version = 0, numPresets = 0;
+        if( ! get(savedMagic) || savedMagic != magic || ! get(version) || version > currentVersion || ! get(numPresets) )
+            return false;
+
+        for( int i = 0; i < numPresets; ++i )
+        {
+            juce::uint8 nameLength = 0;
+            if( ! get(nameLength) || src + nameLength > end )
+                return false;
+
+            auto name = juce::String::fromUTF8(src, nameLength);
+            src += nameLength;
+
+            juce::uint32 stateSize = 0;
+            if( ! get(stateSize) || static_cast<size_t>(end - src) < stateSize )
+                return false;
+
+            BinaryState state;
+            if( state.read(src, stateSize) )
+                onPreset(name, state);
+
+            src += stateSize;
+        }
+
+        return true;
+    }
+
+    static bool save(const juce::File& file, const std::vector<Preset>& presets)
+    {
+        jassert(presets.size() <= std::numeric_limits<juce::uint16>::max());
+
+        juce::MemoryOutputStream mos;
+        mos.writeInt(static_cast<int>(magic));
+        mos.writeShort(static_cast<short>(currentVersion));
+        mos.writeShort(static_cast<short>(presets.size()));
+
+        for( auto& preset : presets )
+        {
+            //names longer than 255 bytes are cut short.
+            auto nameLength = juce::jmin(static_cast<size_t>(std::numeric_limits<juce::uint8>::max()), preset.name.getNumBytesAsUTF8());
+            mos.writeByte(static_cast<char>(nameLength));
+            mos.write(preset.name.toRawUTF8(), nameLength);
+
+            mos.writeInt(static_cast<int>(preset.state.getSize()));
+            mos.write(preset.state.getData(), preset.state.getSize());
+        }
+
+        return file.replaceWithData(mos.getData(), mos.getDataSize());
+    }
+};
@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#include "RealtimeCheck.h"
+
+#if PROJECT13_RT_CHECK
+
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+namespace RealtimeCheck
+{
+    namespace
+    {
+        //plain thread locals: the wrappers run inside malloc, so nothing here may allocate or lock.
+        thread_local int realtimeDepth = 0;
+        thread_local Slot currentSlot;
+
+        std::array<Violation, maxRecorded> recorded;
+        std::atomic<int> numViolations { 0 };
+    }
+
+    void enterRealtime() { ++realtimeDepth; }
+    void leaveRealtime() { --realtimeDepth; }
+
+    Slot setSlot(Slot newSlot)
+    {
+        auto previous = currentSlot;
+        currentSlot = newSlot;
+        return previous;
+    }
+
+    void report(Kind kind, const char* function)
+    {
+        if( realtimeDepth == 0 )
+            return;
+
+        auto index = numViolations.fetch_add(1);
+        if( index < maxRecorded )
+            recorded[static_cast<size_t>(index)] = { kind, function, currentSlot.slot, currentSlot.module };
+    }
+
+    std::vector<Violation> getViolations()
+    {
+        auto num = juce::jmin(numViolations.load(), maxRecorded);
+        return { recorded.begin(), recorded.begin() + num };
+    }
+
+    int getNumViolations() { return numViolations.load(); }
+    void clearViolations() { numViolations.store(0); }
+}
+
+using RealtimeCheck::Kind;
+
+//==============================================================================
+#if defined(__GLIBC__)
+/*
+ glibc: malloc and friends are replaced, and operator new goes through them.
+ the __libc_ versions are glibc's own implementations.
+ */
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size)
+    {
+        RealtimeCheck::report(Kind::Allocation, "malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t num, size_t size)
+    {
+        RealtimeCheck::report(Kind::Allocation, "calloc");
+        return __libc_calloc(num, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        RealtimeCheck::report(Kind::Allocation, "realloc");
+        return __libc_realloc(ptr, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        RealtimeCheck::report(Kind::Allocation, "aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** ptr, size_t alignment, size_t size)
+    {
+        RealtimeCheck::report(Kind::Allocation, "posix_memalign");
+        *ptr = __libc_memalign(alignment, size);
+        return *ptr != nullptr ? 0 : ENOMEM;
+    }
+
+    void free(void* ptr)
+    {
+        if( ptr != nullptr )
+            RealtimeCheck::report(Kind::Deallocation, "free");
+
+        __libc_free(ptr);
+    }
+}
+
+/*
+ the rest are forwarded to the next definition, looked up on first use.
+ 'next' is constant initialised, so there's no static guard: guards can lock, and these wrap the locks.
+ */
+#define PROJECT13_RT_WRAP(kind, returnType, name, params, args)                                 \
+    extern "C" returnType name params                                                           \
+    {                                                                                           \
+        RealtimeCheck::report(kind, #name);                                                     \
+        using Function = returnType (*) params;                                                 \
+        static Function next = nullptr;                                                         \
+        if( next == nullptr )                                                                   \
+            next = reinterpret_cast<Function>(dlsym(RTLD_NEXT, #name));                         \
+        return next args;                                                                       \
+    }
+
+PROJECT13_RT_WRAP(Kind::MutexLock, int, pthread_mutex_lock, (pthread_mutex_t* m), (m))
+PROJECT13_RT_WRAP(Kind::MutexLock, int, pthread_rwlock_rdlock, (pthread_rwlock_t* l), (l))
+PROJECT13_RT_WRAP(Kind::MutexLock, int, pthread_rwlock_wrlock, (pthread_rwlock_t* l), (l))
+
+PROJECT13_RT_WRAP(Kind::SystemCall, ssize_t, read, (int fd, void* buf, size_t count), (fd, buf, count))
+PROJECT13_RT_WRAP(Kind::SystemCall, ssize_t, write, (int fd, const void* buf, size_t count), (fd, buf, count))
+PROJECT13_RT_WRAP(Kind::SystemCall, int, nanosleep, (const struct timespec* req, struct timespec* rem), (req, rem))
+PROJECT13_RT_WRAP(Kind::SystemCall, int, usleep, (useconds_t usec), (usec))
+PROJECT13_RT_WRAP(Kind::SystemCall, int, sched_yield, (), ())
+PROJECT13_RT_WRAP(Kind::SystemCall, int, pthread_cond_wait, (pthread_cond_t* c, pthread_mutex_t* m), (c, m))
+PROJECT13_RT_WRAP(Kind::SystemCall, int, pthread_cond_timedwait, (pthread_cond_t* c, pthread_mutex_t* m, const struct timespec* t), (c, m, t))
+
+#undef PROJECT13_RT_WRAP
+
+#else
+/*
+ elsewhere only operator new/delete are replaced. malloc, locks and system calls go unchecked.
+ */
+void* operator new(std::size_t size)
+{
+    RealtimeCheck::report(Kind::Allocation, "operator new");
+    if( auto* ptr = std::malloc(size) )
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    RealtimeCheck::report(Kind::Allocation, "operator new[]");
+    if( auto* ptr = std::malloc(size) )
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeCheck::report(Kind::Allocation, "operator new");
+    return std::malloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeCheck::report(Kind::Allocation, "operator new[]");
+    return std::malloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if( ptr != nullptr )
+        RealtimeCheck::report(Kind::Deallocation, "operator delete");
+
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    if( ptr != nullptr )
+        RealtimeCheck::report(Kind::Deallocation, "operator delete[]");
+
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { operator delete[](ptr); }
+#endif
+
+#endif
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ Real-time safety checking for test builds: define PROJECT13_RT_CHECK=1, as the benchmark's
+ RealtimeCheck configuration does. Its timings are meaningless, so it only checks.
+
+ While a thread is inside a ScopedRealtime, everything it does that can block is recorded
+ as a violation, along with the chain slot it happened in:
+    heap allocation and freeing: operator new/delete, and with glibc malloc and friends too
+    mutex locks: pthread_mutex_lock, pthread_rwlock_*lock (glibc)
+    blocking system calls: read, write, sleeping, condition variable waits (glibc)
+
+ RealtimeCheck.cpp replaces the allocation functions and wraps the libc calls for the whole
+ process, so it's only for executables we own. In the plugin PROJECT13_RT_CHECK is 0, the
+ scopes are empty and RealtimeCheck.cpp compiles to nothing.
+ */
+#ifndef PROJECT13_RT_CHECK
+ #define PROJECT13_RT_CHECK 0
+#endif
+
+namespace RealtimeCheck
+{
+    enum class Kind
+    {
+        Allocation,
+        Deallocation,
+        MutexLock,
+        SystemCall,
+    };
+
+    //the slot of violations outside the chain: parameter updates, metering, the sub-block scheduling.
+    static constexpr int outsideChain = -1;
+
+    struct Violation
+    {
+        Kind kind = Kind::Allocation;
+        //the function that was called, e.g. "malloc"
+        const char* function = "";
+        int slot = outsideChain;
+        //the DSP_Option in the slot, or "" outside the chain
+        const char* module = "";
+    };
+
+    inline const char* getKindName(Kind kind)
+    {
+        switch (kind)
+        {
+            case Kind::Allocation: return "allocation";
+            case Kind::Deallocation: return "deallocation";
+            case Kind::MutexLock: return "mutex lock";
+            case Kind::SystemCall: return "system call";
+        }
+
+        return "";
+    }
+
+   #if PROJECT13_RT_CHECK
+    struct Slot
+    {
+        int slot = outsideChain;
+        const char* module = "";
+    };
+
+    void enterRealtime();
+    void leaveRealtime();
+    //returns the slot it replaces.
+    Slot setSlot(Slot newSlot);
+
+    //called by the wrappers. records a violation if this thread is inside a ScopedRealtime.
+    void report(Kind kind, const char* function);
+
+    /*
+     the first maxRecorded violations since the last clear, from any thread.
+     getNumViolations() counts them all.
+     */
+    static constexpr int maxRecorded = 256;
+    std::vector<Violation> getViolations();
+    int getNumViolations();
+    void clearViolations();
+
+    struct ScopedRealtime
+    {
+        ScopedRealtime() { enterRealtime(); }
+        ~ScopedRealtime() { leaveRealtime(); }
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtime)
+    };
+
+    struct ScopedSlot
+    {
+        ScopedSlot(int slot, const char* module) : previous(setSlot({ slot, module })) { }
+        ~ScopedSlot() { setSlot(previous); }
+        JUCE_DECLARE_NON_COPYABLE(ScopedSlot)
+    private:
+        Slot previous;
+    };
+   #else
+    struct ScopedRealtime
+    {
+        ScopedRealtime() { }
+    };
+
+    struct ScopedSlot
+    {
+        ScopedSlot(int, const char*) { }
+    };
+   #endif
+}
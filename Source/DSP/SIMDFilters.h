@@ -0,0 +1,498 @@
+/*
+  ==============================================================================
+
+    SIMDFilters.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChannelCount.h"
+
+/*
+ Drop-in replacements for the General Filter's ProcessorDuplicator<IIR::Filter> and for
+ juce::dsp::LadderFilter that run up to SIMDRegister<float>::size() channels at once,
+ one channel per lane. Stereo is L/R in lanes 0 and 1.
+
+ Each block is interleaved into a scratch buffer of registers, the recursion runs once per
+ sample for all channels, and the result is de-interleaved back.
+
+ They do the same float operations in the same order as the stock classes, so the output
+ is identical as long as the compiler doesn't contract the stock classes' scalar
+ multiply-adds into FMAs, and the biquad isn't ramping its coefficients. The benchmark
+ reports the largest difference it sees.
+ */
+
+#if JUCE_USE_SIMD
+
+namespace SIMDFilters
+{
+using SIMD = juce::dsp::SIMDRegister<float>;
+
+inline size_t getNumLaneGroups(size_t numChannels) { return (numChannels + SIMD::size() - 1) / SIMD::size(); }
+
+/*
+ channels [firstChannel, firstChannel + SIMD::size()) of block into the lanes of packed.
+ lanes past the last channel are zeroed.
+ */
+inline void interleave(const juce::dsp::AudioBlock<float>& block, size_t firstChannel, size_t numChannels, SIMD* packed, size_t numSamples)
+{
+    auto* raw = reinterpret_cast<float*>(packed);
+    constexpr auto numLanes = SIMD::size();
+
+    for( size_t lane = 0; lane < numLanes; ++lane )
+    {
+        auto channel = firstChannel + lane;
+        if( channel < numChannels )
+        {
+            const auto* source = block.getChannelPointer(channel);
+            for( size_t i = 0; i < numSamples; ++i )
+                raw[i * numLanes + lane] = source[i];
+        }
+        else
+        {
+            for( size_t i = 0; i < numSamples; ++i )
+                raw[i * numLanes + lane] = 0.f;
+        }
+    }
+}
+
+inline void deinterleave(const SIMD* packed, size_t numSamples, const juce::dsp::AudioBlock<float>& block, size_t firstChannel, size_t numChannels)
+{
+    const auto* raw = reinterpret_cast<const float*>(packed);
+    constexpr auto numLanes = SIMD::size();
+
+    for( size_t lane = 0; lane < numLanes && firstChannel + lane < numChannels; ++lane )
+    {
+        auto* destination = block.getChannelPointer(firstChannel + lane);
+        for( size_t i = 0; i < numSamples; ++i )
+            destination[i] = raw[i * numLanes + lane];
+    }
+}
+
+/*
+ calls processChunk(chunk, firstChannel, numChannels) for every group of channels and every
+ piece of the block that fits in the scratch buffer.
+ */
+template<size_t NumChannels, typename ProcessChunk>
+void forEachLaneGroup(const juce::dsp::AudioBlock<float>& block, size_t maxChunkSize, size_t numPreparedChannels, ProcessChunk&& processChunk)
+{
+    const auto numChannels = juce::jmin(getNumChannels<NumChannels>(block), numPreparedChannels);
+    const auto numSamples = block.getNumSamples();
+
+    for( size_t start = 0; start < numSamples; start += maxChunkSize )
+    {
+        auto chunk = block.getSubBlock(start, juce::jmin(maxChunkSize, numSamples - start));
+        for( size_t firstChannel = 0; firstChannel < numChannels; firstChannel += SIMD::size() )
+            processChunk(chunk, firstChannel, numChannels);
+    }
+}
+} // namespace SIMDFilters
+
+/*
+ 2nd order IIR, transposed direct form II like juce::dsp::IIR::Filter.
+ 'state' has the same role as ProcessorDuplicator::state: the coefficients every channel uses.
+
+ When 'state' changes, the coefficients glide to the new ones linearly over the ramp length
+ instead of stepping. Any straight line between two stable biquads is stable: the (a1, a2)
+ stability triangle is convex. Once the ramp is done the output is the stock filter's again.
+ */
+struct SIMDBiquad
+{
+    using Coefficients = juce::dsp::IIR::Coefficients<float>;
+    using SIMD = SIMDFilters::SIMD;
+
+    static constexpr float defaultRampLengthSeconds = 0.01f;
+
+    Coefficients::Ptr state { new Coefficients(1.f, 0.f, 0.f, 1.f, 0.f, 0.f) };
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        numPreparedChannels = spec.numChannels;
+        packed.resize(spec.maximumBlockSize);
+        s1.resize(SIMDFilters::getNumLaneGroups(spec.numChannels));
+        s2.resize(s1.size());
+        updateRampLength();
+        reset();
+    }
+
+    //also jumps straight to the coefficients in 'state'.
+    void reset()
+    {
+        std::fill(s1.begin(), s1.end(), SIMD::expand(0.f));
+        std::fill(s2.begin(), s2.end(), SIMD::expand(0.f));
+
+        jassert(state->coefficients.size() == numCoefficients);
+        std::copy_n(state->getRawCoefficients(), numCoefficients, target.begin());
+        current = target;
+        rampSamplesLeft = 0;
+    }
+
+    /*
+     how long a change of coefficients glides for. a modulated filter uses the control interval,
+     so it ramps from one control value to the next.
+     */
+    void setCoefficientRampLength(float newRampLengthSeconds)
+    {
+        if( newRampLengthSeconds == rampLengthSeconds )
+            return;
+
+        rampLengthSeconds = newRampLengthSeconds;
+        updateRampLength();
+    }
+
+    template<size_t NumChannels = dynamicChannels>
+    void process(const juce::dsp::ProcessContextReplacing<float>& context)
+    {
+        //b0, b1, b2, a1, a2, already divided by a0
+        jassert(state->coefficients.size() == numCoefficients);
+        const auto* c = state->getRawCoefficients();
+        if( ! std::equal(target.begin(), target.end(), c) )
+            startRamp(c);
+
+        auto block = context.getOutputBlock();
+        size_t start = 0;
+
+        //the ramp goes a scratch buffer's worth at a time, so every lane group steps the coefficients from the same place.
+        while( rampSamplesLeft > 0 && start < block.getNumSamples() )
+        {
+            const auto numSamples = juce::jmin(rampSamplesLeft, block.getNumSamples() - start, packed.size());
+            processWithCoefficients<NumChannels, true>(block.getSubBlock(start, numSamples));
+            advanceRamp(numSamples);
+            start += numSamples;
+        }
+
+        if( start < block.getNumSamples() )
+            processWithCoefficients<NumChannels, false>(block.getSubBlock(start));
+    }
+private:
+    static constexpr size_t numCoefficients = 5;
+
+    template<size_t NumChannels, bool Ramping>
+    void processWithCoefficients(const juce::dsp::AudioBlock<float>& block)
+    {
+        const auto b0 = SIMD::expand(current[0]);
+        const auto b1 = SIMD::expand(current[1]);
+        const auto b2 = SIMD::expand(current[2]);
+        const auto a1 = SIMD::expand(current[3]);
+        const auto a2 = SIMD::expand(current[4]);
+
+        const auto db0 = SIMD::expand(step[0]);
+        const auto db1 = SIMD::expand(step[1]);
+        const auto db2 = SIMD::expand(step[2]);
+        const auto da1 = SIMD::expand(step[3]);
+        const auto da2 = SIMD::expand(step[4]);
+
+        SIMDFilters::forEachLaneGroup<NumChannels>(block, packed.size(), numPreparedChannels,
+                                                   [&](const juce::dsp::AudioBlock<float>& chunk, size_t firstChannel, size_t numChannels)
+        {
+            const auto numSamples = chunk.getNumSamples();
+            const auto group = firstChannel / SIMD::size();
+
+            SIMDFilters::interleave(chunk, firstChannel, numChannels, packed.data(), numSamples);
+
+            auto lv1 = s1[group];
+            auto lv2 = s2[group];
+            auto cb0 = b0, cb1 = b1, cb2 = b2, ca1 = a1, ca2 = a2;
+
+            for( size_t i = 0; i < numSamples; ++i )
+            {
+                if constexpr ( Ramping )
+                {
+                    cb0 += db0;
+                    cb1 += db1;
+                    cb2 += db2;
+                    ca1 += da1;
+                    ca2 += da2;
+                }
+
+                auto input = packed[i];
+                auto output = input * cb0 + lv1;
+                packed[i] = output;
+
+                lv1 = input * cb1 - output * ca1 + lv2;
+                lv2 = input * cb2 - output * ca2;
+            }
+
+            s1[group] = snapToZero(lv1);
+            s2[group] = snapToZero(lv2);
+
+            SIMDFilters::deinterleave(packed.data(), numSamples, chunk, firstChannel, numChannels);
+        });
+    }
+
+    void startRamp(const float* newCoefficients)
+    {
+        std::copy_n(newCoefficients, numCoefficients, target.begin());
+        rampSamplesLeft = rampLengthSamples;
+
+        for( size_t i = 0; i < numCoefficients; ++i )
+            step[i] = (target[i] - current[i]) / static_cast<float>(rampSamplesLeft);
+    }
+
+    void advanceRamp(size_t numSamples)
+    {
+        rampSamplesLeft -= numSamples;
+        if( rampSamplesLeft == 0 )
+        {
+            current = target;
+            return;
+        }
+
+        for( size_t i = 0; i < numCoefficients; ++i )
+            current[i] += step[i] * static_cast<float>(numSamples);
+    }
+
+    void updateRampLength()
+    {
+        rampLengthSamples = static_cast<size_t>(juce::jmax(1, juce::roundToInt(rampLengthSeconds * sampleRate)));
+    }
+
+    //same as IIR::Filter: once per block, per lane.
+    static SIMD snapToZero(SIMD value)
+    {
+        for( size_t lane = 0; lane < SIMD::size(); ++lane )
+        {
+            auto x = value.get(lane);
+            JUCE_SNAP_TO_ZERO(x);
+            value.set(lane, x);
+        }
+
+        return value;
+    }
+
+    size_t numPreparedChannels = 0;
+    std::vector<SIMD> packed, s1, s2;
+
+    std::array<float, numCoefficients> current { 1.f, 0.f, 0.f, 0.f, 0.f }, target = current, step {};
+    size_t rampSamplesLeft = 0, rampLengthSamples = 1;
+    double sampleRate = 44100.0;
+    float rampLengthSeconds = defaultRampLengthSeconds;
+};
+
+/*
+ The juce::dsp::LadderFilter algorithm with the channels in SIMD lanes.
+ The one pole stages and the output mix are vectorised. The tanh saturation is a lookup
+ table, so it's evaluated per lane.
+ */
+struct SIMDLadderFilter
+{
+    using Mode = juce::dsp::LadderFilterMode;
+    using SIMD = SIMDFilters::SIMD;
+
+    static constexpr float defaultRampLengthSeconds = 0.05f;
+
+    SIMDLadderFilter()
+    {
+        //the same defaults as juce::dsp::LadderFilter
+        setSampleRate(1000.f);
+        setResonance(0.f);
+        setDrive(1.2f);
+
+        mode = Mode::LPF24;
+        setMode(Mode::LPF12);
+    }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        numPreparedChannels = spec.numChannels;
+        state.resize(SIMDFilters::getNumLaneGroups(spec.numChannels));
+        packed.resize(spec.maximumBlockSize);
+        cutoffRamp.resize(spec.maximumBlockSize);
+        resonanceRamp.resize(spec.maximumBlockSize);
+        prepareSampleRate(spec.sampleRate);
+    }
+
+    /*
+     re-prepares at a new rate, keeping the buffers prepare() allocated, so it's safe on the audio thread.
+     */
+    void prepareSampleRate(double newSampleRate)
+    {
+        setSampleRate(static_cast<float>(newSampleRate));
+        reset();
+    }
+
+    void reset()
+    {
+        for( auto& s : state )
+            s.fill(SIMD::expand(0.f));
+
+        cutoffTransformSmoother.setCurrentAndTargetValue(cutoffTransformSmoother.getTargetValue());
+        scaledResonanceSmoother.setCurrentAndTargetValue(scaledResonanceSmoother.getTargetValue());
+    }
+
+    void setMode(Mode newMode)
+    {
+        if( newMode == mode )
+            return;
+
+        switch (newMode)
+        {
+            case Mode::LPF12: A = {{ 0.f, 0.f, 1.f, 0.f, 0.f }}; comp = 0.5f; break;
+            case Mode::HPF12: A = {{ 1.f, -2.f, 1.f, 0.f, 0.f }}; comp = 0.f; break;
+            case Mode::BPF12: A = {{ 0.f, 0.f, -1.f, 1.f, 0.f }}; comp = 0.5f; break;
+            case Mode::LPF24: A = {{ 0.f, 0.f, 0.f, 0.f, 1.f }}; comp = 0.5f; break;
+            case Mode::HPF24: A = {{ 1.f, -4.f, 6.f, -4.f, 1.f }}; comp = 0.f; break;
+            case Mode::BPF24: A = {{ 0.f, 0.f, 1.f, -2.f, 1.f }}; comp = 0.5f; break;
+        }
+
+        constexpr auto outputGain = 1.2f;
+        for( auto& a : A )
+            a *= outputGain;
+
+        mode = newMode;
+        reset();
+    }
+
+    void setCutoffFrequencyHz(float newCutoff)
+    {
+        jassert(newCutoff > 0.f);
+        cutoffFreqHz = newCutoff;
+        updateCutoffFreq();
+    }
+
+    void setResonance(float newResonance)
+    {
+        jassert(newResonance >= 0.f && newResonance <= 1.f);
+        resonance = newResonance;
+        scaledResonanceSmoother.setTargetValue(juce::jmap(resonance, 0.1f, 1.f));
+    }
+
+    void setDrive(float newDrive)
+    {
+        jassert(newDrive >= 1.f);
+        drive = newDrive;
+        gain = std::pow(drive, -2.642f) * 0.6103f + 0.3903f;
+        drive2 = drive * 0.04f + 0.96f;
+        gain2 = std::pow(drive2, -2.642f) * 0.6103f + 0.3903f;
+    }
+
+    /*
+     how long cutoff and resonance changes glide for. defaultRampLengthSeconds matches the juce filter.
+     a modulated filter uses the control interval, so it ramps from one control value to the next.
+     */
+    void setParameterRampLength(float newRampLengthSeconds)
+    {
+        if( newRampLengthSeconds == rampLengthSeconds )
+            return;
+
+        rampLengthSeconds = newRampLengthSeconds;
+        cutoffTransformSmoother.reset(sampleRate, rampLengthSeconds);
+        scaledResonanceSmoother.reset(sampleRate, rampLengthSeconds);
+    }
+
+    template<size_t NumChannels = dynamicChannels>
+    void process(const juce::dsp::ProcessContextReplacing<float>& context)
+    {
+        constexpr auto numLanes = SIMD::size();
+        const auto& saturation = getSaturationTable();
+        const auto numChannels = juce::jmin(getNumChannels<NumChannels>(context.getOutputBlock()), numPreparedChannels);
+
+        for( size_t start = 0; start < context.getOutputBlock().getNumSamples(); start += packed.size() )
+        {
+            auto chunk = context.getOutputBlock().getSubBlock(start, juce::jmin(packed.size(), context.getOutputBlock().getNumSamples() - start));
+            const auto numSamples = chunk.getNumSamples();
+
+            //the smoothers advance once per sample, shared by every channel.
+            for( size_t i = 0; i < numSamples; ++i )
+            {
+                cutoffRamp[i] = cutoffTransformSmoother.getNextValue();
+                resonanceRamp[i] = scaledResonanceSmoother.getNextValue();
+            }
+
+            for( size_t firstChannel = 0; firstChannel < numChannels; firstChannel += numLanes )
+            {
+                const auto numLanesUsed = juce::jmin(numLanes, numChannels - firstChannel);
+                auto& s = state[firstChannel / numLanes];
+
+                SIMDFilters::interleave(chunk, firstChannel, numChannels, packed.data(), numSamples);
+                auto* raw = reinterpret_cast<float*>(packed.data());
+
+                for( size_t i = 0; i < numSamples; ++i )
+                {
+                    const auto a1 = cutoffRamp[i];
+                    const auto g = a1 * -1.f + 1.f;
+                    const auto b0 = g * 0.76923076923f;
+                    const auto b1 = g * 0.23076923076f;
+
+                    alignas(sizeof(SIMD)) std::array<float, numLanes> dxLanes {};
+                    alignas(sizeof(SIMD)) std::array<float, numLanes> feedbackLanes {};
+                    for( size_t lane = 0; lane < numLanesUsed; ++lane )
+                    {
+                        dxLanes[lane] = gain * saturation(drive * raw[i * numLanes + lane]);
+                        feedbackLanes[lane] = gain2 * saturation(drive2 * s[4].get(lane));
+                    }
+
+                    const auto dx = SIMD::fromRawArray(dxLanes.data());
+                    const auto feedback = SIMD::fromRawArray(feedbackLanes.data());
+
+                    const auto a = dx + SIMD::expand(resonanceRamp[i] * -4.f) * (feedback - dx * comp);
+                    const auto b = s[0] * b1 + s[1] * a1 + a * b0;
+                    const auto c = s[1] * b1 + s[2] * a1 + b * b0;
+                    const auto d = s[2] * b1 + s[3] * a1 + c * b0;
+                    const auto e = s[3] * b1 + s[4] * a1 + d * b0;
+
+                    s[0] = a;
+                    s[1] = b;
+                    s[2] = c;
+                    s[3] = d;
+                    s[4] = e;
+
+                    packed[i] = a * A[0] + b * A[1] + c * A[2] + d * A[3] + e * A[4];
+                }
+
+                SIMDFilters::deinterleave(packed.data(), numSamples, chunk, firstChannel, numChannels);
+            }
+        }
+    }
+private:
+    void setSampleRate(float newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        cutoffFreqScaler = static_cast<float>(-2.0 * juce::MathConstants<double>::pi) / newSampleRate;
+
+        cutoffTransformSmoother.reset(sampleRate, rampLengthSeconds);
+        scaledResonanceSmoother.reset(sampleRate, rampLengthSeconds);
+
+        updateCutoffFreq();
+    }
+
+    void updateCutoffFreq()
+    {
+        cutoffTransformSmoother.setTargetValue(std::exp(cutoffFreqHz * cutoffFreqScaler));
+    }
+
+    static const juce::dsp::LookupTableTransform<float>& getSaturationTable()
+    {
+        static const juce::dsp::LookupTableTransform<float> table { [](float x) { return std::tanh(x); }, -5.f, 5.f, 128 };
+        return table;
+    }
+
+    static constexpr size_t numStates = 5;
+
+    size_t numPreparedChannels = 0;
+    std::vector<std::array<SIMD, numStates>> state;
+    std::vector<SIMD> packed;
+    std::vector<float> cutoffRamp, resonanceRamp;
+
+    juce::SmoothedValue<float> cutoffTransformSmoother, scaledResonanceSmoother;
+    float cutoffFreqHz = 200.f, resonance = 0.f, drive = 1.2f, drive2 = 1.f, gain = 1.f, gain2 = 1.f, comp = 0.f;
+    float cutoffFreqScaler = 0.f;
+    float sampleRate = 1000.f, rampLengthSeconds = defaultRampLengthSeconds;
+
+    std::array<float, numStates> A {};
+    Mode mode = Mode::LPF24;
+};
+
+#else
+
+//no SIMD: the stock classes.
+using SIMDBiquad = juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>>;
+using SIMDLadderFilter = juce::dsp::LadderFilter<float>;
+
+#endif
@@ -0,0 +1,241 @@
+/*
+  ==============================================================================
+
+    SnapshotMorph.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ One writer, one reader, neither ever waits.
+ The writer fills getWriteBuffer() and publishes it. The reader pulls and reads
+ getReadBuffer(), which stays its own until the next pull. A frame published before the
+ reader got to the previous one replaces it.
+ */
+template<typename T>
+struct TripleBuffer
+{
+    //before either side starts, e.g. to size every buffer.
+    template<typename F>
+    void forEachBuffer(F&& f)
+    {
+        for( auto& buffer : buffers )
+            f(buffer);
+    }
+
+    //writer
+    T& getWriteBuffer() { return buffers[static_cast<size_t>(writeIndex)]; }
+
+    void publish()
+    {
+        writeIndex = middle.exchange(writeIndex | freshBit) & indexMask;
+    }
+
+    //reader. true if a new frame was published since the last pull.
+    bool pull()
+    {
+        if( (middle.load() & freshBit) == 0 )
+            return false;
+
+        readIndex = middle.exchange(readIndex) & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const { return buffers[static_cast<size_t>(readIndex)]; }
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4;
+
+    std::array<T, 3> buffers;
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle { 2 };
+};
+
+/*
+ Morphs between up to numSnapshots full parameter snapshots, off the audio thread.
+
+ The morph position (0 - 1) sweeps across the captured snapshots in slot order. Between two
+ neighbours, continuous parameters are interpolated in their normalised range. Discrete
+ ones (choices, toggles) and the order switch over from one snapshot to the next at the
+ crossover, halfway between them.
+
+ This thread polls the position and, only when it moves, writes a new Frame into the triple
+ buffer for the audio thread to pull. Capturing a snapshot doesn't touch the parameters
+ until the position moves again.
+ */
+template<typename Order>
+struct SnapshotMorpher : juce::Thread
+{
+    static constexpr int numSnapshots = 4;
+    static constexpr float crossover = 0.5f;
+
+    enum class ParameterKind
+    {
+        Continuous,
+        Discrete,
+        //not morphed, e.g. the morph position itself.
+        Excluded,
+    };
+
+    struct Snapshot
+    {
+        std::vector<float> values;
+        Order order {};
+    };
+
+    struct Frame
+    {
+        //normalised, one per parameter. Excluded ones are left alone.
+        std::vector<float> values;
+        Order order {};
+    };
+
+    SnapshotMorpher() : juce::Thread("Snapshot Morph") { }
+
+    ~SnapshotMorpher() override
+    {
+        stopThread(500);
+    }
+
+    /*
+     call once, before the audio thread starts pulling frames. starts the thread.
+     */
+    void prepare(std::vector<ParameterKind> newKinds, const juce::RangedAudioParameter& newPosition)
+    {
+        kinds = std::move(newKinds);
+        position = &newPosition;
+        frames.forEachBuffer([this](Frame& frame) { frame.values.resize(kinds.size()); });
+        startThread();
+    }
+
+    const std::vector<ParameterKind>& getParameterKinds() const { return kinds; }
+
+    //==============================================================================
+    //message thread
+
+    void setSnapshot(int slot, Snapshot snapshot)
+    {
+        jassert(juce::isPositiveAndBelow(slot, numSnapshots));
+        jassert(snapshot.values.size() == kinds.size());
+
+        const juce::ScopedLock sl(snapshotLock);
+        snapshots[static_cast<size_t>(slot)] = std::move(snapshot);
+    }
+
+    void clearSnapshot(int slot)
+    {
+        const juce::ScopedLock sl(snapshotLock);
+        snapshots[static_cast<size_t>(slot)].reset();
+    }
+
+    std::optional<Snapshot> getSnapshot(int slot) const
+    {
+        const juce::ScopedLock sl(snapshotLock);
+        return snapshots[static_cast<size_t>(slot)];
+    }
+
+    bool hasSnapshot(int slot) const
+    {
+        const juce::ScopedLock sl(snapshotLock);
+        return snapshots[static_cast<size_t>(slot)].has_value();
+    }
+
+    /*
+     the morph doesn't run while one of these exists. afterwards, the position it finds is
+     taken as the starting point instead of being morphed to, e.g. after restoring a state.
+     */
+    struct ScopedRestore
+    {
+        explicit ScopedRestore(SnapshotMorpher& m) : morpher(m) { morpher.snapshotLock.enter(); }
+        ~ScopedRestore()
+        {
+            morpher.resyncRequested = true;
+            morpher.snapshotLock.exit();
+        }
+    private:
+        SnapshotMorpher& morpher;
+    };
+
+    //==============================================================================
+    //audio thread
+
+    TripleBuffer<Frame> frames;
+
+    //==============================================================================
+    void run() override
+    {
+        auto lastPosition = position->getValue();
+
+        while( ! threadShouldExit() )
+        {
+            {
+                const juce::ScopedLock sl(snapshotLock);
+                auto newPosition = position->getValue();
+                if( resyncRequested )
+                {
+                    lastPosition = newPosition;
+                    resyncRequested = false;
+                }
+
+                if( newPosition != lastPosition )
+                {
+                    if( morph(newPosition, frames.getWriteBuffer()) )
+                        frames.publish();
+
+                    lastPosition = newPosition;
+                }
+            }
+
+            //polling, so the audio thread never has to signal (and lock) anything.
+            wait(5);
+        }
+    }
+private:
+    //false with fewer than 2 snapshots: there's nothing to morph between.
+    bool morph(float morphPosition, Frame& frame) const
+    {
+        std::array<const Snapshot*, numSnapshots> captured {};
+        int numCaptured = 0;
+        for( auto& snapshot : snapshots )
+        {
+            if( snapshot.has_value() )
+                captured[static_cast<size_t>(numCaptured++)] = &*snapshot;
+        }
+
+        if( numCaptured < 2 )
+            return false;
+
+        auto x = juce::jlimit(0.f, 1.f, morphPosition) * static_cast<float>(numCaptured - 1);
+        auto segment = juce::jmin(static_cast<int>(x), numCaptured - 2);
+        auto t = x - static_cast<float>(segment);
+
+        auto& from = *captured[static_cast<size_t>(segment)];
+        auto& to = *captured[static_cast<size_t>(segment + 1)];
+        auto& nearest = t < crossover ? from : to;
+
+        for( size_t i = 0; i < kinds.size(); ++i )
+        {
+            if( kinds[i] == ParameterKind::Continuous )
+                frame.values[i] = from.values[i] + t * (to.values[i] - from.values[i]);
+            else
+                frame.values[i] = nearest.values[i];
+        }
+
+        frame.order = nearest.order;
+        return true;
+    }
+
+    std::vector<ParameterKind> kinds;
+    const juce::RangedAudioParameter* position = nullptr;
+
+    mutable juce::CriticalSection snapshotLock;
+    std::array<std::optional<Snapshot>, numSnapshots> snapshots;
+    bool resyncRequested = false;
+};
@@ -0,0 +1,278 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../SimpleMultiBandComp/Source/DSP/Fifo.h"
+
+/*
+ One analyser tap: the audio thread push()es blocks, the analyser thread turns them into
+ a log-frequency spectrum and a Path the editor can stroke without rebuilding it.
+
+ Everything is allocated in the constructor. The audio thread only mixes the block down
+ to mono in a staging buffer and copies full chunks into the Fifo.
+
+ The path is built in a 0..1 x 0..1 space: x is log frequency from minFrequency to
+ maxFrequency, y is level from maxDb (top) to minDb (bottom). Scale it to the bounds
+ it's drawn in.
+ */
+struct SpectrumAnalyser
+{
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int chunkSize = 512;
+    static constexpr int numBins = 256;
+
+    static constexpr float minFrequency = 20.f;
+    static constexpr float maxFrequency = 20000.f;
+    static constexpr float minDb = -72.f;
+    static constexpr float maxDb = 6.f;
+
+    SpectrumAnalyser()
+    {
+        staging.setSize(1, chunkSize);
+        staging.clear();
+        chunksFifo.prepare(chunkSize, 1);
+        pulledChunk.setSize(1, chunkSize);
+
+        history.resize(fftSize, 0.f);
+        fftData.resize(2 * fftSize, 0.f);
+        binStart.resize(numBins + 1, 0.f);
+        smoothedDb.resize(numBins, minDb);
+    }
+
+    //==============================================================================
+    //audio thread
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate.store(newSampleRate);
+        stagingPosition = 0;
+    }
+
+    void push(const juce::dsp::AudioBlock<float>& block)
+    {
+        const auto numChannels = block.getNumChannels();
+        if( numChannels == 0 )
+            return;
+
+        const auto channelGain = 1.f / static_cast<float>(numChannels);
+        auto* destination = staging.getWritePointer(0);
+
+        int start = 0;
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+        while( start < numSamples )
+        {
+            auto length = juce::jmin(numSamples - start, chunkSize - stagingPosition);
+            auto* span = destination + stagingPosition;
+
+            juce::FloatVectorOperations::multiply(span, block.getChannelPointer(0) + start, channelGain, length);
+            for( size_t ch = 1; ch < numChannels; ++ch )
+                juce::FloatVectorOperations::addWithMultiply(span, block.getChannelPointer(ch) + start, channelGain, length);
+
+            stagingPosition += length;
+            start += length;
+
+            if( stagingPosition == chunkSize )
+            {
+                //same size as the prepared slots, so the copy never reallocates. dropped if the fifo is full.
+                chunksFifo.push(staging);
+                stagingPosition = 0;
+            }
+        }
+    }
+
+    //==============================================================================
+    //analyser thread
+
+    /*
+     runs an FFT for every chunk that arrived and rebuilds the path.
+     returns false if there was nothing to do.
+     */
+    bool processAvailable()
+    {
+        bool processed = false;
+        while( chunksFifo.pull(pulledChunk) )
+        {
+            //slide the history along by one chunk, so consecutive FFTs overlap by 75%.
+            std::copy(history.begin() + chunkSize, history.end(), history.begin());
+            std::copy(pulledChunk.getReadPointer(0), pulledChunk.getReadPointer(0) + chunkSize, history.end() - chunkSize);
+
+            runFFT();
+            processed = true;
+        }
+
+        if( processed )
+            buildPath();
+
+        return processed;
+    }
+
+    //==============================================================================
+    //message thread
+
+    int getPathVersion() const { return pathVersion.load(); }
+
+    void getPath(juce::Path& destination) const
+    {
+        const juce::ScopedLock lock(pathLock);
+        destination = path;
+    }
+private:
+    void runFFT()
+    {
+        if( auto rate = sampleRate.load(); rate != binSampleRate )
+            updateBinRanges(rate);
+
+        std::copy(history.begin(), history.end(), fftData.begin());
+        window.multiplyWithWindowingTable(fftData.data(), fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+        //a full scale sine peaks at fftSize / 4 through a hann window.
+        const auto normalise = 4.f / static_cast<float>(fftSize);
+        const auto lastIndex = static_cast<float>(fftSize / 2);
+
+        for( int bin = 0; bin < numBins; ++bin )
+        {
+            auto start = juce::jmin(binStart[static_cast<size_t>(bin)], lastIndex);
+            auto end = juce::jmin(binStart[static_cast<size_t>(bin) + 1], lastIndex);
+
+            float magnitude = 0.f;
+            if( end - start < 1.f )
+            {
+                //narrower than one FFT bin (low frequencies): interpolate.
+                auto index = static_cast<int>(start);
+                auto fraction = start - static_cast<float>(index);
+                auto next = juce::jmin(index + 1, fftSize / 2);
+                magnitude = fftData[static_cast<size_t>(index)] + fraction * (fftData[static_cast<size_t>(next)] - fftData[static_cast<size_t>(index)]);
+            }
+            else
+            {
+                for( auto i = static_cast<int>(start); i < static_cast<int>(end); ++i )
+                    magnitude = juce::jmax(magnitude, fftData[static_cast<size_t>(i)]);
+            }
+
+            auto db = juce::Decibels::gainToDecibels(magnitude * normalise, minDb);
+
+            //instant attack, slow release
+            auto& smoothed = smoothedDb[static_cast<size_t>(bin)];
+            smoothed = db > smoothed ? db : smoothed + releaseCoefficient * (db - smoothed);
+        }
+    }
+
+    void updateBinRanges(double rate)
+    {
+        binSampleRate = rate;
+        const auto hzPerIndex = static_cast<float>(rate) / static_cast<float>(fftSize);
+
+        for( int bin = 0; bin <= numBins; ++bin )
+        {
+            auto proportion = static_cast<float>(bin) / static_cast<float>(numBins);
+            auto frequency = minFrequency * std::pow(maxFrequency / minFrequency, proportion);
+            binStart[static_cast<size_t>(bin)] = frequency / hzPerIndex;
+        }
+    }
+
+    void buildPath()
+    {
+        juce::Path newPath;
+        newPath.preallocateSpace(3 * numBins);
+
+        for( int bin = 0; bin < numBins; ++bin )
+        {
+            auto x = (static_cast<float>(bin) + 0.5f) / static_cast<float>(numBins);
+            auto y = juce::jmap(smoothedDb[static_cast<size_t>(bin)], minDb, maxDb, 1.f, 0.f);
+
+            if( bin == 0 )
+                newPath.startNewSubPath(x, y);
+            else
+                newPath.lineTo(x, y);
+        }
+
+        {
+            const juce::ScopedLock lock(pathLock);
+            path.swapWithPath(newPath);
+        }
+
+        ++pathVersion;
+    }
+
+    //audio thread
+    juce::AudioBuffer<float> staging;
+    int stagingPosition = 0;
+    std::atomic<double> sampleRate { 44100.0 };
+
+    SimpleMBComp::Fifo<juce::AudioBuffer<float>> chunksFifo;
+
+    //analyser thread
+    static constexpr float releaseCoefficient = 0.1f;
+
+    juce::AudioBuffer<float> pulledChunk;
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { static_cast<size_t>(fftSize), juce::dsp::WindowingFunction<float>::hann, false };
+    std::vector<float> history, fftData, binStart, smoothedDb;
+    double binSampleRate = 0.0;
+
+    //shared with the message thread, never the audio thread.
+    juce::CriticalSection pathLock;
+    juce::Path path;
+    std::atomic<int> pathVersion { 0 };
+};
+
+/*
+ Runs the pre and post chain analysers while at least one editor is showing them.
+ */
+struct SpectrumAnalyserThread : juce::Thread
+{
+    SpectrumAnalyserThread(SpectrumAnalyser& pre, SpectrumAnalyser& post) :
+        juce::Thread("Spectrum Analyser"),
+        preAnalyser(pre),
+        postAnalyser(post)
+    {
+    }
+
+    ~SpectrumAnalyserThread() override
+    {
+        stopThread(500);
+    }
+
+    //message thread: called by every editor that shows the analysers.
+    void addViewer()
+    {
+        if( numViewers++ == 0 )
+            startThread();
+    }
+
+    void removeViewer()
+    {
+        if( --numViewers == 0 )
+            stopThread(500);
+    }
+
+    //the audio thread skips feeding the analysers when nobody is looking.
+    bool hasViewers() const { return numViewers.load() > 0; }
+
+    void run() override
+    {
+        while( ! threadShouldExit() )
+        {
+            auto processedPre = preAnalyser.processAvailable();
+            auto processedPost = postAnalyser.processAvailable();
+
+            if( ! processedPre && ! processedPost )
+                wait(10);
+        }
+    }
+private:
+    SpectrumAnalyser& preAnalyser;
+    SpectrumAnalyser& postAnalyser;
+    std::atomic<int> numViewers { 0 };
+};
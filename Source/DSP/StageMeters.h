@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    StageMeters.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../SimpleMultiBandComp/Source/DSP/Fifo.h"
+#include "ChannelCount.h"
+
+/*
+ linear peak and RMS of each channel at one point in the chain.
+ */
+struct MeterLevels
+{
+    static constexpr size_t maxChannels = 2;
+
+    std::array<float, maxChannels> peak {};
+    std::array<float, maxChannels> rms {};
+};
+
+/*
+ Peak/RMS meters at NumPoints places in the chain.
+
+ The audio thread calls measure() for every point it passes and advance() once per block.
+ Levels are accumulated over a window of 1/refreshRateHz seconds and the finished window
+ is pushed into a Fifo, so the editor pulls them at display rate regardless of the host
+ block size. Nothing allocates or locks after prepare().
+ */
+template<size_t NumPoints>
+struct StageMeters
+{
+    using Levels = std::array<MeterLevels, NumPoints>;
+
+    void prepare(double sampleRate, double refreshRateHz = 60.0)
+    {
+        windowLength = juce::jmax(1, juce::roundToInt(sampleRate / refreshRateHz));
+        reset();
+    }
+
+    void reset()
+    {
+        peak = {};
+        sumOfSquares = {};
+        samplesInWindow = 0;
+    }
+
+    template<size_t NumChannels = dynamicChannels>
+    void measure(size_t point, const juce::dsp::AudioBlock<float>& block)
+    {
+        jassert(point < NumPoints);
+
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+        const auto numChannels = juce::jmin(getNumChannels<NumChannels>(block), MeterLevels::maxChannels);
+
+        for( size_t ch = 0; ch < numChannels; ++ch )
+        {
+            const auto* data = block.getChannelPointer(ch);
+
+            auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+            peak[point][ch] = juce::jmax(peak[point][ch], -range.getStart(), range.getEnd());
+            sumOfSquares[point][ch] += getSumOfSquares(data, static_cast<size_t>(numSamples));
+        }
+
+        //mono: show the same level on both sides.
+        for( auto ch = numChannels; ch < MeterLevels::maxChannels && numChannels > 0; ++ch )
+        {
+            peak[point][ch] = peak[point][0];
+            sumOfSquares[point][ch] = sumOfSquares[point][0];
+        }
+    }
+
+    /*
+     call once per block, after every point has been measured.
+     */
+    void advance(int numSamples)
+    {
+        samplesInWindow += numSamples;
+        if( samplesInWindow < windowLength )
+            return;
+
+        Levels levels;
+        for( size_t point = 0; point < NumPoints; ++point )
+        {
+            for( size_t ch = 0; ch < MeterLevels::maxChannels; ++ch )
+            {
+                levels[point].peak[ch] = peak[point][ch];
+                levels[point].rms[ch] = std::sqrt(static_cast<float>(sumOfSquares[point][ch] / samplesInWindow));
+            }
+        }
+
+        //if the editor isn't pulling, the fifo is full and this window is dropped.
+        levelsFifo.push(levels);
+        reset();
+    }
+
+    /*
+     message thread: the most recent window, or false if there's nothing new.
+     */
+    bool pullLatest(Levels& levels)
+    {
+        bool pulled = false;
+        while( levelsFifo.pull(levels) )
+        {
+            pulled = true;
+        }
+
+        return pulled;
+    }
+
+    static float getSumOfSquares(const float* data, size_t numSamples)
+    {
+        float sum = 0.f;
+        size_t i = 0;
+
+       #if JUCE_USE_SIMD
+        using SIMD = juce::dsp::SIMDRegister<float>;
+
+        //scalar until the data is SIMD aligned
+        while( i < numSamples && ! SIMD::isSIMDAligned(data + i) )
+        {
+            sum += data[i] * data[i];
+            ++i;
+        }
+
+        auto sums = SIMD::expand(0.f);
+        for( ; i + SIMD::size() <= numSamples; i += SIMD::size() )
+        {
+            auto x = SIMD::fromRawArray(data + i);
+            sums += x * x;
+        }
+
+        sum += sums.sum();
+       #endif
+
+        for( ; i < numSamples; ++i )
+            sum += data[i] * data[i];
+
+        return sum;
+    }
+private:
+    using ChannelValues = std::array<std::array<float, MeterLevels::maxChannels>, NumPoints>;
+
+    ChannelValues peak {};
+    //double: a window at 192k is ~3200 samples of small squares.
+    std::array<std::array<double, MeterLevels::maxChannels>, NumPoints> sumOfSquares {};
+
+    int windowLength = 1;
+    int samplesInWindow = 0;
+
+    SimpleMBComp::Fifo<Levels> levelsFifo;
+};
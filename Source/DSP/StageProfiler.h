@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    StageProfiler.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+/*
+ CPU time of NumStages chain stages, per host block.
+
+ The audio thread wraps each stage in a ScopedStage. The time it spends in a stage over a
+ whole block, all of its sub-blocks included, is written into that stage's ring buffer
+ as a fraction of the block's real-time budget (its length in seconds). The editor reads the
+ rings for rolling min/mean/p99.
+
+ Timing costs two clock reads per stage per sub-block, so it only runs while there are
+ viewers or a trace is being recorded. Nothing allocates or locks on the audio thread.
+ */
+template<size_t NumStages>
+struct StageProfiler
+{
+    using Clock = std::chrono::steady_clock;
+
+    //blocks of history per stage.
+    static constexpr size_t historySize = 256;
+
+    struct Stats
+    {
+        //fractions of the real-time budget.
+        float min = 0.f;
+        float mean = 0.f;
+        float p99 = 0.f;
+    };
+
+    using StageStats = std::array<Stats, NumStages>;
+
+    /*
+     stage: 0 - NumStages-1, or blockStage for a whole processBlock call.
+     */
+    static constexpr int blockStage = -1;
+
+    struct TraceEvent
+    {
+        int stage = blockStage;
+        Clock::time_point start, end;
+    };
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+    }
+
+    //==============================================================================
+    //message thread
+
+    void addViewer() { ++numViewers; }
+    void removeViewer() { --numViewers; }
+
+    /*
+     the last historySize blocks, or fewer if that many haven't been profiled yet.
+     */
+    StageStats getStats() const
+    {
+        StageStats stats {};
+        const auto numBlocks = juce::jmin(numWritten.load(), historySize);
+        if( numBlocks == 0 )
+            return stats;
+
+        std::array<float, historySize> values;
+        for( size_t stage = 0; stage < NumStages; ++stage )
+        {
+            for( size_t i = 0; i < numBlocks; ++i )
+                values[i] = history[stage][i].load(std::memory_order_relaxed);
+
+            auto* end = values.data() + numBlocks;
+            auto& s = stats[stage];
+            s.min = *std::min_element(values.data(), end);
+            s.mean = std::accumulate(values.data(), end, 0.f) / static_cast<float>(numBlocks);
+
+            auto* p99 = values.data() + juce::jmin(numBlocks - 1, numBlocks * 99 / 100);
+            std::nth_element(values.data(), p99, end);
+            s.p99 = *p99;
+        }
+
+        return stats;
+    }
+
+    /*
+     offline use, between processBlock calls: from the next block on, records every stage and
+     block as a TraceEvent, up to maxEvents. stopTrace() hands them over.
+     */
+    void startTrace(size_t maxEvents)
+    {
+        traceEvents.clear();
+        traceEvents.reserve(maxEvents);
+        tracing.store(true);
+    }
+
+    std::vector<TraceEvent> stopTrace()
+    {
+        tracing.store(false);
+        return std::move(traceEvents);
+    }
+
+    //==============================================================================
+    //audio thread
+
+    void beginBlock()
+    {
+        traceThisBlock = tracing.load();
+        active = numViewers.load() > 0 || traceThisBlock;
+        if( active )
+        {
+            blockTimes = {};
+            blockStart = Clock::now();
+        }
+    }
+
+    void endBlock(int numSamples)
+    {
+        if( ! active )
+            return;
+
+        const auto blockEnd = Clock::now();
+        addTraceEvent(blockStage, blockStart, blockEnd);
+
+        const auto budget = static_cast<double>(numSamples) / sampleRate;
+        if( budget <= 0.0 )
+            return;
+
+        const auto index = numWritten.load() % historySize;
+        for( size_t stage = 0; stage < NumStages; ++stage )
+        {
+            auto load = std::chrono::duration<double>(blockTimes[stage]).count() / budget;
+            history[stage][index].store(static_cast<float>(load), std::memory_order_relaxed);
+        }
+
+        numWritten.fetch_add(1);
+    }
+
+    struct ScopedStage
+    {
+        ScopedStage(StageProfiler& p, size_t s) : profiler(p), stage(s)
+        {
+            if( profiler.active )
+                start = Clock::now();
+        }
+
+        ~ScopedStage()
+        {
+            if( ! profiler.active )
+                return;
+
+            auto end = Clock::now();
+            profiler.blockTimes[stage] += end - start;
+            profiler.addTraceEvent(static_cast<int>(stage), start, end);
+        }
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    private:
+        StageProfiler& profiler;
+        size_t stage;
+        Clock::time_point start;
+    };
+private:
+    void addTraceEvent(int stage, Clock::time_point start, Clock::time_point end)
+    {
+        //within the capacity startTrace() reserved, so this never reallocates.
+        if( traceThisBlock && traceEvents.size() < traceEvents.capacity() )
+            traceEvents.push_back({ stage, start, end });
+    }
+
+    double sampleRate = 44100.0;
+
+    std::atomic<int> numViewers { 0 };
+    bool active = false;
+
+    Clock::time_point blockStart;
+    std::array<Clock::duration, NumStages> blockTimes {};
+
+    std::array<std::array<std::atomic<float>, historySize>, NumStages> history {};
+    std::atomic<size_t> numWritten { 0 };
+
+    std::atomic<bool> tracing { false };
+    bool traceThisBlock = false;
+    std::vector<TraceEvent> traceEvents;
+};
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    SubBlockScheduler.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ Slices host blocks into sub-blocks of at most maxSubBlockSize samples.
+
+ Sub-blocks sit on a grid that runs across host blocks, so where the control updates land
+ doesn't depend on how the host splits the audio: a 1 sample host block only reaches a
+ boundary once every sub-block. At each boundary onBoundary() applies the control updates
+ and returns the length of the next sub-block. A sub-block that straddles two host blocks
+ is processed in two pieces, with no boundary in between.
+
+ Nothing downstream ever sees more than maxSubBlockSize samples, so it can all be
+ prepared for that size and any host block size works without reallocating.
+ */
+struct SubBlockScheduler
+{
+    void prepare(int newMaxSubBlockSize)
+    {
+        jassert(newMaxSubBlockSize > 0);
+        maxSubBlockSize = juce::jmax(1, newMaxSubBlockSize);
+        reset();
+    }
+
+    //the next sample starts a sub-block.
+    void reset() { samplesUntilBoundary = 0; }
+
+    int getMaxSubBlockSize() const { return maxSubBlockSize; }
+
+    /*
+     onBoundary: () -> int, the length of the sub-block starting here. clamped to 1 - maxSubBlockSize.
+     processPiece: (AudioBlock<float>&), called for every piece of every sub-block in order.
+     */
+    template<typename OnBoundary, typename ProcessPiece>
+    void process(juce::dsp::AudioBlock<float>& block, OnBoundary&& onBoundary, ProcessPiece&& processPiece)
+    {
+        const auto numSamples = block.getNumSamples();
+
+        size_t start = 0;
+        while( start < numSamples )
+        {
+            if( samplesUntilBoundary == 0 )
+                samplesUntilBoundary = static_cast<size_t>(juce::jlimit(1, maxSubBlockSize, onBoundary()));
+
+            const auto length = juce::jmin(samplesUntilBoundary, numSamples - start);
+            auto piece = block.getSubBlock(start, length);
+            processPiece(piece);
+
+            start += length;
+            samplesUntilBoundary -= length;
+        }
+    }
+private:
+    int maxSubBlockSize = 32;
+    size_t samplesUntilBoundary = 0;
+};
@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    TailSleep.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <cmath>
+
+/*
+ How long a module keeps sounding after its input stops, as an estimate from its settings:
+ a delay before the tail starts, then an exponential decay.
+
+ gainDb is the module's small-signal gain. A quiet tail from an earlier slot goes through
+ it, so a gain there keeps that tail above the threshold for longer.
+ */
+struct ModuleTail
+{
+    double delaySeconds = 0.0;
+    double secondsPer60dB = 0.0;
+    double gainDb = 0.0;
+
+    /*
+     a loop 'loopSeconds' long that feeds back 'feedback' of its output: the tail starts
+     after one trip round, and loses 20log10(1 / |feedback|) dB on every trip after that.
+     */
+    static ModuleTail feedbackLoop(double loopSeconds, double feedback)
+    {
+        ModuleTail tail;
+        tail.delaySeconds = loopSeconds;
+
+        auto lossDb = -juce::Decibels::gainToDecibels(juce::jlimit(0.0, maxFeedback, std::abs(feedback)), -1000.0);
+        if( lossDb < 1000.0 )
+            tail.secondsPer60dB = loopSeconds * 60.0 / lossDb;
+
+        return tail;
+    }
+
+    /*
+     a resonance at frequencyHz with quality q. it rings with a bandwidth of f / q, so it
+     decays at pi f / q nepers a second: 60dB in ln(1000) q / (pi f).
+     */
+    static ModuleTail resonance(double frequencyHz, double q)
+    {
+        ModuleTail tail;
+        tail.secondsPer60dB = std::log(1000.0) * q / (juce::MathConstants<double>::pi * juce::jmax(frequencyHz, 1.0));
+        return tail;
+    }
+
+    //the longest a tail is ever reported as. a feedback of 1 would never decay.
+    static constexpr double maxTailSeconds = 600.0;
+    static constexpr double maxFeedback = 0.999;
+};
+
+/*
+ the tail of modules in series, slot order: each slot's tail has to decay by decayDb, plus
+ the gain of every slot after it. adding the slots' tails up is the worst case, where each
+ one only starts decaying once the one before has.
+ */
+template<size_t NumSlots>
+double getChainTailSeconds(const std::array<ModuleTail, NumSlots>& slots, double decayDb)
+{
+    double seconds = 0.0;
+    double gainAfterDb = 0.0;
+
+    for( auto slot = slots.rbegin(); slot != slots.rend(); ++slot )
+    {
+        seconds += slot->delaySeconds + slot->secondsPer60dB * (decayDb + gainAfterDb) / 60.0;
+        gainAfterDb += juce::jmax(0.0, slot->gainDb);
+    }
+
+    return juce::jmin(seconds, ModuleTail::maxTailSeconds);
+}
+
+//the most the chain can make quiet input louder: the gains above 0dB of every slot.
+template<size_t NumSlots>
+double getChainGainDb(const std::array<ModuleTail, NumSlots>& slots)
+{
+    double gainDb = 0.0;
+    for( const auto& slot : slots )
+        gainDb += juce::jmax(0.0, slot.gainDb);
+
+    return gainDb;
+}
+
+/*
+ Counts how long the input has been silent: quiet enough that every sample of every channel
+ stays below thresholdDb at the chain's output. Once that's longer than the chain's tail, the
+ chain would only output silence and can sleep. Any block with signal in it resets the count,
+ so the chain wakes on that block.
+ */
+struct SilenceDetector
+{
+    //at the chain's output.
+    static constexpr float thresholdDb = -80.f;
+    //thresholdDb as a gain, spelled out so nothing is worked out on the audio thread.
+    static constexpr float threshold = 1.0e-4f;
+
+    void reset() { silentSamples = silentBefore = 0; }
+
+    /*
+     the input threshold is lower by the chain's gain, see getChainGainDb(), so input the
+     chain would bring above thresholdDb isn't taken for silence.
+     */
+    void setChainGainDb(double chainGainDb)
+    {
+        inputThreshold = threshold * static_cast<float>(juce::Decibels::decibelsToGain(-chainGainDb, -1000.0));
+    }
+
+    /*
+     call once per block, before processing it. false if the block has signal in it.
+     */
+    bool process(const juce::dsp::AudioBlock<float>& block)
+    {
+        if( ! isSilent(block) )
+        {
+            reset();
+            return false;
+        }
+
+        silentBefore = silentSamples;
+        silentSamples += static_cast<juce::int64>(block.getNumSamples());
+        return true;
+    }
+
+    //how long the input had been silent before the block process() last saw.
+    juce::int64 getSilentSamplesBefore() const { return silentBefore; }
+
+    bool isSilent(const juce::dsp::AudioBlock<float>& block) const
+    {
+        const auto numSamples = static_cast<int>(block.getNumSamples());
+        for( size_t ch = 0; ch < block.getNumChannels(); ++ch )
+        {
+            auto range = juce::FloatVectorOperations::findMinAndMax(block.getChannelPointer(ch), numSamples);
+            if( juce::jmax(-range.getStart(), range.getEnd()) >= inputThreshold )
+                return false;
+        }
+
+        return true;
+    }
+private:
+    float inputThreshold = threshold;
+    juce::int64 silentSamples = 0;
+    juce::int64 silentBefore = 0;
+};
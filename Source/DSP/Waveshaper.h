@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    Waveshaper.h
+    Created: 17 Oct 2026
+    Author:  Project13
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChannelCount.h"
+
+enum class WaveshaperCurve
+{
+    Tanh,
+    SoftClip,
+    AsymmetricTube,
+    HardClip,
+};
+
+/*
+ Static waveshaper for the OverDrive slot.
+
+ drive: input gain, 1 - 100
+ tanh and asymmetric tube: lookup tables shared by every instance.
+ soft clip: cubic polynomial, vectorised with SIMDRegister.
+ hard clip: FloatVectorOperations::clip.
+ */
+struct Waveshaper
+{
+    static constexpr double defaultDriveRampLengthSeconds = 0.02;
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        drive.reset(sampleRate, driveRampLengthSeconds);
+    }
+
+    void reset()
+    {
+        drive.setCurrentAndTargetValue(drive.getTargetValue());
+    }
+
+    void setDrive(float newDrive)
+    {
+        drive.setTargetValue(newDrive);
+    }
+
+    /*
+     defaultDriveRampLengthSeconds unless the drive is modulated.
+     */
+    void setDriveRampLength(double newRampLengthSeconds)
+    {
+        if( newRampLengthSeconds == driveRampLengthSeconds )
+            return;
+
+        driveRampLengthSeconds = newRampLengthSeconds;
+        drive.reset(sampleRate, driveRampLengthSeconds);
+    }
+
+    void setCurve(WaveshaperCurve newCurve)
+    {
+        curve = newCurve;
+    }
+
+    template<size_t NumChannels = dynamicChannels>
+    void process(const juce::dsp::ProcessContextReplacing<float>& context)
+    {
+        auto& block = context.getOutputBlock();
+        const auto numSamples = block.getNumSamples();
+        const auto numChannels = getNumChannels<NumChannels>(block);
+
+        applyDrive<NumChannels>(block);
+
+        for( size_t ch = 0; ch < numChannels; ++ch )
+        {
+            auto* data = block.getChannelPointer(ch);
+
+            switch (curve)
+            {
+                case WaveshaperCurve::Tanh:
+                    getTanhTable().process(data, data, numSamples);
+                    break;
+                case WaveshaperCurve::SoftClip:
+                    applySoftClip(data, numSamples);
+                    break;
+                case WaveshaperCurve::AsymmetricTube:
+                    getTubeTable().process(data, data, numSamples);
+                    break;
+                case WaveshaperCurve::HardClip:
+                    juce::FloatVectorOperations::clip(data, data, -1.f, 1.f, static_cast<int>(numSamples));
+                    break;
+            }
+        }
+    }
+
+    static float softClip(float x)
+    {
+        x = juce::jlimit(-1.f, 1.f, x);
+        return x * (1.5f - 0.5f * x * x);
+    }
+
+    /*
+     tanh(x + bias) shifted back through 0 and scaled into -1..1.
+     the positive half saturates sooner, which adds even harmonics.
+     */
+    static float asymmetricTube(float x)
+    {
+        constexpr float bias = 0.25f;
+        static const float offset = std::tanh(bias);
+        return (std::tanh(x + bias) - offset) / (1.f + offset);
+    }
+private:
+    template<size_t NumChannels>
+    void applyDrive(const juce::dsp::AudioBlock<float>& block)
+    {
+        const auto numSamples = block.getNumSamples();
+        const auto numChannels = getNumChannels<NumChannels>(block);
+
+        if( ! drive.isSmoothing() )
+        {
+            for( size_t ch = 0; ch < numChannels; ++ch )
+                juce::FloatVectorOperations::multiply(block.getChannelPointer(ch), drive.getTargetValue(), static_cast<int>(numSamples));
+            
+            return;
+        }
+
+        for( size_t i = 0; i < numSamples; ++i )
+        {
+            auto gain = drive.getNextValue();
+            for( size_t ch = 0; ch < numChannels; ++ch )
+                block.getChannelPointer(ch)[i] *= gain;
+        }
+    }
+
+    static void applySoftClip(float* data, size_t numSamples)
+    {
+        size_t i = 0;
+
+       #if JUCE_USE_SIMD
+        using SIMD = juce::dsp::SIMDRegister<float>;
+
+        //scalar until the data is SIMD aligned
+        while( i < numSamples && ! SIMD::isSIMDAligned(data + i) )
+        {
+            data[i] = softClip(data[i]);
+            ++i;
+        }
+
+        const auto lower = SIMD::expand(-1.f);
+        const auto upper = SIMD::expand(1.f);
+        const auto a = SIMD::expand(1.5f);
+        const auto b = SIMD::expand(0.5f);
+
+        for( ; i + SIMD::size() <= numSamples; i += SIMD::size() )
+        {
+            auto x = SIMD::fromRawArray(data + i);
+            x = SIMD::min(SIMD::max(x, lower), upper);
+            (x * (a - b * x * x)).copyToRawArray(data + i);
+        }
+       #endif
+
+        for( ; i < numSamples; ++i )
+            data[i] = softClip(data[i]);
+    }
+
+    //out of range input is clamped to the table's ends, where both curves are flat.
+    static const juce::dsp::LookupTableTransform<float>& getTanhTable()
+    {
+        static const juce::dsp::LookupTableTransform<float> table { [](float x) { return std::tanh(x); }, -6.f, 6.f, 1024 };
+        return table;
+    }
+
+    static const juce::dsp::LookupTableTransform<float>& getTubeTable()
+    {
+        static const juce::dsp::LookupTableTransform<float> table { [](float x) { return asymmetricTube(x); }, -6.f, 6.f, 1024 };
+        return table;
+    }
+
+    juce::SmoothedValue<float> drive { 1.f };
+    double sampleRate = 44100.0;
+    double driveRampLengthSeconds = defaultDriveRampLengthSeconds;
+    WaveshaperCurve curve = WaveshaperCurve::Tanh;
+};
@@ -13,13 +13,28 @@
 Project13AudioProcessorEditor::Project13AudioProcessorEditor (Project13AudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
+    addAndMakeVisible(genericEditor);
+    addAndMakeVisible(meterDisplay);
+    addAndMakeVisible(spectrumDisplay);
+    addAndMakeVisible(midiLearnPanel);
+    addAndMakeVisible(snapshotPanel);
+    addAndMakeVisible(presetPanel);
+    addAndMakeVisible(profilerDisplay);
+    
+    audioProcessor.spectrumAnalyserThread.addViewer();
+    audioProcessor.stageProfiler.addViewer();
+    
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (600, 1090);
+    
+    startTimerHz(30);
 }
 
 Project13AudioProcessorEditor::~Project13AudioProcessorEditor()
 {
+    audioProcessor.spectrumAnalyserThread.removeViewer();
+    audioProcessor.stageProfiler.removeViewer();
 }
 
 //==============================================================================
@@ -27,14 +42,319 @@ void Project13AudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void Project13AudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
+    auto bounds = getLocalBounds();
+    midiLearnPanel.setBounds(bounds.removeFromTop(30));
+    snapshotPanel.setBounds(bounds.removeFromTop(30));
+    presetPanel.setBounds(bounds.removeFromTop(30));
+    meterDisplay.setBounds(bounds.removeFromBottom(150));
+    profilerDisplay.setBounds(bounds.removeFromBottom(100));
+    spectrumDisplay.setBounds(bounds.removeFromBottom(200));
+    genericEditor.setBounds(bounds);
+}
+
+void Project13AudioProcessorEditor::timerCallback()
+{
+    Project13AudioProcessor::Meters::Levels levels;
+    if( audioProcessor.stageMeters.pullLatest(levels) )
+        meterDisplay.update(levels);
+    
+    spectrumDisplay.update();
+    profilerDisplay.update(audioProcessor.stageProfiler.getStats());
+    midiLearnPanel.update();
+    snapshotPanel.update();
+}
+
+//==============================================================================
+MidiLearnPanel::MidiLearnPanel(Project13AudioProcessor& p) : processor(p)
+{
+    auto& parameters = processor.getParameters();
+    for( int i = 0; i < parameters.size(); ++i )
+        parameterBox.addItem(parameters[i]->getName(64), i + 1);
+    
+    parameterBox.setSelectedId(1, juce::dontSendNotification);
+    parameterBox.onChange = [this]() { update(); };
+    
+    learnButton.onClick = [this]()
+    {
+        auto& midiLearn = processor.midiLearn;
+        if( midiLearn.getLearningParameter() == getSelectedParameterIndex() )
+            midiLearn.stopLearning();
+        else
+            midiLearn.startLearning(getSelectedParameterIndex());
+        
+        update();
+    };
+    
+    clearButton.onClick = [this]()
+    {
+        processor.midiLearn.clearMappingsFor(getSelectedParameterIndex());
+        update();
+    };
+    
+    addAndMakeVisible(parameterBox);
+    addAndMakeVisible(learnButton);
+    addAndMakeVisible(clearButton);
+    addAndMakeVisible(mappingLabel);
+}
+
+/*
+ the audio thread does the learning, so this is polled from the editor's timer.
+ */
+void MidiLearnPanel::update()
+{
+    auto& midiLearn = processor.midiLearn;
+    auto index = getSelectedParameterIndex();
+    auto learning = midiLearn.getLearningParameter() == index;
+    
+    learnButton.setToggleState(learning, juce::dontSendNotification);
+    
+    if( learning )
+        mappingLabel.setText("Move a controller", juce::dontSendNotification);
+    else if( auto controller = midiLearn.getControllerFor(index); controller != MidiLearn::notMapped )
+        mappingLabel.setText("CC " + juce::String(controller), juce::dontSendNotification);
+    else
+        mappingLabel.setText("Not mapped", juce::dontSendNotification);
+}
+
+void MidiLearnPanel::resized()
+{
+    auto bounds = getLocalBounds().reduced(4);
+    mappingLabel.setBounds(bounds.removeFromRight(120));
+    clearButton.setBounds(bounds.removeFromRight(60));
+    learnButton.setBounds(bounds.removeFromRight(60));
+    parameterBox.setBounds(bounds);
+}
+
+//==============================================================================
+SnapshotPanel::SnapshotPanel(Project13AudioProcessor& p) : processor(p)
+{
+    for( size_t slot = 0; slot < captureButtons.size(); ++slot )
+    {
+        auto& button = captureButtons[slot];
+        button.setButtonText(juce::String::charToString(static_cast<juce::juce_wchar>('A' + slot)));
+        button.onClick = [this, slot]()
+        {
+            processor.captureSnapshot(static_cast<int>(slot));
+            update();
+        };
+        
+        addAndMakeVisible(button);
+    }
+    
+    clearButton.onClick = [this]()
+    {
+        for( int slot = 0; slot < Project13AudioProcessor::Morpher::numSnapshots; ++slot )
+            processor.clearSnapshot(slot);
+        
+        update();
+    };
+    
+    addAndMakeVisible(clearButton);
+}
+
+/*
+ lit: the slot holds a snapshot. polled, since restoring a state fills them too.
+ */
+void SnapshotPanel::update()
+{
+    for( size_t slot = 0; slot < captureButtons.size(); ++slot )
+        captureButtons[slot].setToggleState(processor.hasSnapshot(static_cast<int>(slot)), juce::dontSendNotification);
+}
+
+void SnapshotPanel::resized()
+{
+    auto bounds = getLocalBounds().reduced(4);
+    clearButton.setBounds(bounds.removeFromRight(60));
+    
+    const auto buttonWidth = bounds.getWidth() / static_cast<int>(captureButtons.size());
+    for( auto& button : captureButtons )
+        button.setBounds(bounds.removeFromLeft(buttonWidth));
+}
+
+//==============================================================================
+PresetPanel::PresetPanel(Project13AudioProcessor& p) : processor(p)
+{
+    nameEditor.setTextToShowWhenEmpty("Preset name", juce::Colours::grey);
+    nameEditor.onReturnKey = [this]() { save(); };
+    saveButton.onClick = [this]() { save(); };
+    
+    addAndMakeVisible(nameEditor);
+    addAndMakeVisible(saveButton);
+    addAndMakeVisible(statusLabel);
+}
+
+void PresetPanel::save()
+{
+    auto name = nameEditor.getText().trim();
+    if( name.isEmpty() )
+    {
+        statusLabel.setText("Name it first", juce::dontSendNotification);
+        return;
+    }
+    
+    statusLabel.setText(processor.savePreset(name) ? "Saved" : "Could not save", juce::dontSendNotification);
+}
+
+void PresetPanel::resized()
+{
+    auto bounds = getLocalBounds().reduced(4);
+    statusLabel.setBounds(bounds.removeFromRight(120));
+    saveButton.setBounds(bounds.removeFromRight(120));
+    nameEditor.setBounds(bounds);
+}
+
+//==============================================================================
+SpectrumDisplay::SpectrumDisplay(SpectrumAnalyser& pre, SpectrumAnalyser& post) :
+    traces { Trace { pre, {}, -1 }, Trace { post, {}, -1 } }
+{
+}
+
+void SpectrumDisplay::update()
+{
+    bool changed = false;
+    for( auto& trace : traces )
+    {
+        if( auto version = trace.analyser.getPathVersion(); version != trace.version )
+        {
+            trace.analyser.getPath(trace.path);
+            trace.version = version;
+            changed = true;
+        }
+    }
+    
+    if( changed )
+        repaint();
+}
+
+void SpectrumDisplay::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+    
+    auto bounds = getLocalBounds().reduced(4).toFloat();
+    
+    //0dB line
+    auto zeroDbY = juce::jmap(0.f, SpectrumAnalyser::minDb, SpectrumAnalyser::maxDb, bounds.getBottom(), bounds.getY());
+    g.setColour(juce::Colours::darkgrey);
+    g.drawHorizontalLine(juce::roundToInt(zeroDbY), bounds.getX(), bounds.getRight());
+    
+    auto transform = juce::AffineTransform::scale(bounds.getWidth(), bounds.getHeight()).translated(bounds.getX(), bounds.getY());
+    
+    g.setColour(juce::Colours::grey);
+    g.strokePath(traces[0].path, juce::PathStrokeType(1.f), transform);
+    
+    g.setColour(juce::Colours::white);
+    g.strokePath(traces[1].path, juce::PathStrokeType(1.f), transform);
+}
+
+//==============================================================================
+void ProfilerDisplay::update(const Project13AudioProcessor::Profiler::StageStats& newStats)
+{
+    stats = newStats;
+    repaint();
+}
+
+void ProfilerDisplay::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+    
+    auto bounds = getLocalBounds().reduced(4);
+    const auto rowHeight = bounds.getHeight() / static_cast<int>(stats.size() + 1);
+    
+    auto drawRow = [&](const juce::String& name, const juce::String& min, const juce::String& mean, const juce::String& p99)
+    {
+        auto row = bounds.removeFromTop(rowHeight);
+        g.drawFittedText(name, row.removeFromLeft(row.getWidth() / 4), juce::Justification::centredLeft, 1);
+        
+        const auto columnWidth = row.getWidth() / 3;
+        g.drawFittedText(min, row.removeFromLeft(columnWidth), juce::Justification::centredRight, 1);
+        g.drawFittedText(mean, row.removeFromLeft(columnWidth), juce::Justification::centredRight, 1);
+        g.drawFittedText(p99, row, juce::Justification::centredRight, 1);
+    };
+    
+    auto percent = [](float load) { return juce::String(load * 100.f, 2) + "%"; };
+    
+    g.setFont(12.f);
+    g.setColour(juce::Colours::grey);
+    drawRow("CPU", "min", "mean", "p99");
+    
+    g.setColour(juce::Colours::white);
+    for( size_t i = 0; i < stats.size(); ++i )
+    {
+        auto option = static_cast<Project13AudioProcessor::DSP_Option>(i);
+        drawRow(Project13AudioProcessor::getModuleName(option), percent(stats[i].min), percent(stats[i].mean), percent(stats[i].p99));
+    }
+}
+
+//==============================================================================
+void StageMeterDisplay::update(const Project13AudioProcessor::Meters::Levels& newLevels)
+{
+    //peaks fall back slowly instead of flickering at the refresh rate.
+    constexpr float peakDecay = 0.85f;
+    
+    for( size_t point = 0; point < levels.size(); ++point )
+    {
+        for( size_t ch = 0; ch < MeterLevels::maxChannels; ++ch )
+        {
+            levels[point].peak[ch] = juce::jmax(newLevels[point].peak[ch], levels[point].peak[ch] * peakDecay);
+            levels[point].rms[ch] = newLevels[point].rms[ch];
+        }
+    }
+    
+    repaint();
+}
+
+void StageMeterDisplay::paint(juce::Graphics& g)
+{
+    constexpr float minDb = -60.f;
+    constexpr float maxDb = 6.f;
+    
+    g.fillAll(juce::Colours::black);
+    
+    auto bounds = getLocalBounds().reduced(4);
+    auto labelArea = bounds.removeFromBottom(16);
+    const auto pointWidth = bounds.getWidth() / static_cast<int>(levels.size());
+    
+    auto levelToY = [&](float gain, juce::Rectangle<int> area)
+    {
+        auto db = juce::jlimit(minDb, maxDb, juce::Decibels::gainToDecibels(gain, minDb));
+        return juce::jmap(db, minDb, maxDb, static_cast<float>(area.getBottom()), static_cast<float>(area.getY()));
+    };
+    
+    g.setFont(12.f);
+    for( size_t point = 0; point < levels.size(); ++point )
+    {
+        auto pointArea = bounds.removeFromLeft(pointWidth).reduced(4, 0);
+        auto label = labelArea.removeFromLeft(pointWidth);
+        
+        juce::String name;
+        if( point == Project13AudioProcessor::inputMeterPoint )
+            name = "In";
+        else if( point == Project13AudioProcessor::outputMeterPoint )
+            name = "Out";
+        else
+            name = juce::String(static_cast<int>(point));
+        
+        g.setColour(juce::Colours::white);
+        g.drawFittedText(name, label, juce::Justification::centred, 1);
+        
+        const auto channelWidth = pointArea.getWidth() / static_cast<int>(MeterLevels::maxChannels);
+        for( size_t ch = 0; ch < MeterLevels::maxChannels; ++ch )
+        {
+            auto channelArea = pointArea.removeFromLeft(channelWidth).reduced(1, 0);
+            
+            auto rmsY = levelToY(levels[point].rms[ch], channelArea);
+            g.setColour(juce::Colours::green);
+            g.fillRect(channelArea.toFloat().withTop(rmsY));
+            
+            auto peakY = levelToY(levels[point].peak[ch], channelArea);
+            g.setColour(levels[point].peak[ch] > 1.f ? juce::Colours::red : juce::Colours::yellow);
+            g.drawHorizontalLine(juce::roundToInt(peakY), static_cast<float>(channelArea.getX()), static_cast<float>(channelArea.getRight()));
+        }
+    }
 }
@@ -11,10 +11,113 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
+//==============================================================================
+/*
+ Peak (line) and RMS (bar) meters for every point in Project13AudioProcessor::Meters,
+ left to right: input, each DSP_Order slot, output.
+ */
+struct StageMeterDisplay : juce::Component
+{
+    void update(const Project13AudioProcessor::Meters::Levels& newLevels);
+    void paint(juce::Graphics& g) override;
+private:
+    Project13AudioProcessor::Meters::Levels levels {};
+};
+
+//==============================================================================
+/*
+ Pre (grey) and post (white) chain spectra. The paths are built by the analyser thread,
+ this only scales and strokes them.
+ */
+struct SpectrumDisplay : juce::Component
+{
+    SpectrumDisplay(SpectrumAnalyser& pre, SpectrumAnalyser& post);
+    
+    void update();
+    void paint(juce::Graphics& g) override;
+private:
+    struct Trace
+    {
+        SpectrumAnalyser& analyser;
+        juce::Path path;
+        int version = -1;
+    };
+    
+    std::array<Trace, 2> traces;
+};
+
+//==============================================================================
+/*
+ Each module's CPU load over the last Profiler::historySize blocks, as a percentage of the
+ blocks' real-time budget: min, mean and 99th percentile.
+ */
+struct ProfilerDisplay : juce::Component
+{
+    void update(const Project13AudioProcessor::Profiler::StageStats& newStats);
+    void paint(juce::Graphics& g) override;
+private:
+    Project13AudioProcessor::Profiler::StageStats stats {};
+};
+
+//==============================================================================
+/*
+ MIDI learn for any parameter: pick it, press Learn, move a controller.
+ */
+struct MidiLearnPanel : juce::Component
+{
+    explicit MidiLearnPanel(Project13AudioProcessor& processor);
+    
+    void update();
+    void resized() override;
+private:
+    int getSelectedParameterIndex() const { return parameterBox.getSelectedId() - 1; }
+    
+    Project13AudioProcessor& processor;
+    juce::ComboBox parameterBox;
+    juce::TextButton learnButton { "Learn" }, clearButton { "Clear" };
+    juce::Label mappingLabel;
+};
+
+//==============================================================================
+/*
+ Morph snapshots: press a slot to capture the current settings into it.
+ The Morph parameter sweeps across the captured slots.
+ */
+struct SnapshotPanel : juce::Component
+{
+    explicit SnapshotPanel(Project13AudioProcessor& processor);
+    
+    void update();
+    void resized() override;
+private:
+    Project13AudioProcessor& processor;
+    std::array<juce::TextButton, Project13AudioProcessor::Morpher::numSnapshots> captureButtons;
+    juce::TextButton clearButton { "Clear" };
+};
+
+//==============================================================================
+/*
+ Saves the current settings into the preset bank under a name. The host's program list
+ picks new presets up the next time the plugin is opened.
+ */
+struct PresetPanel : juce::Component
+{
+    explicit PresetPanel(Project13AudioProcessor& processor);
+    
+    void resized() override;
+private:
+    void save();
+    
+    Project13AudioProcessor& processor;
+    juce::TextEditor nameEditor;
+    juce::TextButton saveButton { "Save Preset" };
+    juce::Label statusLabel;
+};
+
 //==============================================================================
 /**
 */
-class Project13AudioProcessorEditor  : public juce::AudioProcessorEditor
+class Project13AudioProcessorEditor  : public juce::AudioProcessorEditor, private juce::Timer
 {
 public:
     Project13AudioProcessorEditor (Project13AudioProcessor&);
@@ -25,9 +128,19 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+    
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     Project13AudioProcessor& audioProcessor;
+    
+    juce::GenericAudioProcessorEditor genericEditor { audioProcessor };
+    StageMeterDisplay meterDisplay;
+    SpectrumDisplay spectrumDisplay { audioProcessor.preChainSpectrum, audioProcessor.postChainSpectrum };
+    MidiLearnPanel midiLearnPanel { audioProcessor };
+    SnapshotPanel snapshotPanel { audioProcessor };
+    PresetPanel presetPanel { audioProcessor };
+    ProfilerDisplay profilerDisplay;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Project13AudioProcessorEditor)
 };
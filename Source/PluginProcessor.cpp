@@ -9,6 +9,11 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+#ifndef JucePlugin_Name
+//console targets like Benchmark/ compile this file without the plugin defines
+ #define JucePlugin_Name "Project13"
+#endif
+
 auto getPhaserRateName() { return juce::String("Phaser RateHz"); }
 auto getPhaserCenterFreqName() { return juce::String("Phaser Center FreqHz"); }
 auto getPhaserDepthName() { return juce::String("Phaser Depth %" ); }
@@ -22,11 +27,25 @@ auto getChorusFeedbackName() { return juce::String("Chorus Feedback %"); }
 auto getChorusMixName() { return juce::String("Chorus Mix %"); }
 
 auto getOverdriveSaturationName() { return juce::String("OverDrive Saturation"); }
+auto getOverdriveCurveName() { return juce::String("OverDrive Curve"); }
+auto getOverdriveMixName() { return juce::String("OverDrive Mix %"); }
+
+auto getOverdriveCurveChoices()
+{
+    return juce::StringArray
+    {
+        "Tanh",
+        "Soft Clip",
+        "Asymmetric Tube",
+        "Hard Clip",
+    };
+}
 
 auto getLadderFilterModeName() { return juce::String("Ladder Filter Mode"); }
 auto getLadderFilterCutoffName() { return juce::String("Ladder Filter Cutoff Hz"); }
 auto getLadderFilterResonanceName() { return juce::String("Ladder Filter Resonance"); }
 auto getLadderFilterDriveName() { return juce::String("Ladder Filter Drive"); }
+auto getLadderFilterMixName() { return juce::String("Ladder Filter Mix %"); }
 
 auto getLadderFilterChoices()
 {
@@ -41,6 +60,26 @@ auto getLadderFilterChoices()
     };
 }
 
+auto getOversamplingChoices()
+{
+    return juce::StringArray
+    {
+        "1x",
+        "2x",
+        "4x",
+        "8x",
+    };
+}
+
+auto getOversamplingFilterChoices()
+{
+    return juce::StringArray
+    {
+        "Polyphase IIR",
+        "Linear Phase FIR",
+    };
+}
+
 auto getGeneralFilterChoices()
 {
     return juce::StringArray
@@ -56,9 +95,210 @@ auto getGeneralFilterModeName() { return juce::String("General Filter Mode"); }
 auto getGeneralFilterFreqName() { return juce::String("General Filter Freq hz"); }
 auto getGeneralFilterQualityName() { return juce::String("General Filter Quality"); }
 auto getGeneralFilterGainName() { return juce::String("General Filter Gain"); }
+auto getGeneralFilterMixName() { return juce::String("General Filter Mix %"); }
+
+auto getGlobalMixName() { return juce::String("Global Mix %"); }
+
+auto getOverdriveOversamplingName() { return juce::String("OverDrive Oversampling"); }
+auto getLadderFilterOversamplingName() { return juce::String("Ladder Filter Oversampling"); }
+auto getOversamplingFilterName() { return juce::String("Oversampling Filter"); }
+
+auto getDelayTimeName() { return juce::String("Delay Time ms"); }
+auto getDelaySyncName() { return juce::String("Delay Sync"); }
+auto getDelayNoteName() { return juce::String("Delay Note"); }
+auto getDelayFeedbackName() { return juce::String("Delay Feedback %"); }
+auto getDelayMixName() { return juce::String("Delay Mix %"); }
+auto getDelayPingPongName() { return juce::String("Delay Ping Pong"); }
+
+auto getDelayNoteChoices()
+{
+    return juce::StringArray
+    {
+        "1/32",
+        "1/16T",
+        "1/16",
+        "1/16D",
+        "1/8T",
+        "1/8",
+        "1/8D",
+        "1/4T",
+        "1/4",
+        "1/4D",
+        "1/2",
+        "1/1",
+    };
+}
+
+/*
+ length of each getDelayNoteChoices() entry, in quarter notes
+ */
+float getDelayNoteLengthInBeats(int index)
+{
+    constexpr auto lengths = std::array
+    {
+        0.125f,
+        1.f / 6.f,
+        0.25f,
+        0.375f,
+        1.f / 3.f,
+        0.5f,
+        0.75f,
+        2.f / 3.f,
+        1.f,
+        1.5f,
+        2.f,
+        4.f,
+    };
+    
+    return lengths[static_cast<size_t>(juce::jlimit(0, static_cast<int>(lengths.size()) - 1, index))];
+}
+
+auto getPhaserBypassName() { return juce::String("Phaser Bypass"); }
+auto getChorusBypassName() { return juce::String("Chorus Bypass"); }
+auto getOverdriveBypassName() { return juce::String("OverDrive Bypass"); }
+auto getLadderFilterBypassName() { return juce::String("Ladder Filter Bypass"); }
+auto getGeneralFilterBypassName() { return juce::String("General Filter Bypass"); }
+auto getDelayBypassName() { return juce::String("Delay Bypass"); }
+
+auto getLFORateName(int lfo) { return "LFO " + juce::String(lfo + 1) + " Rate Hz"; }
+auto getLFOShapeName(int lfo) { return "LFO " + juce::String(lfo + 1) + " Shape"; }
+
+auto getLFOShapeChoices()
+{
+    return juce::StringArray
+    {
+        "Sine",
+        "Triangle",
+        "Saw",
+        "Square",
+    };
+}
+
+auto getEnvelopeAttackName() { return juce::String("Envelope Attack ms"); }
+auto getEnvelopeReleaseName() { return juce::String("Envelope Release ms"); }
+
+auto getStepSequencerRateName() { return juce::String("Step Sequencer Rate Hz"); }
+auto getStepSequencerStepName(int step) { return "Step Sequencer Step " + juce::String(step + 1); }
+
+auto getModSlotSourceName(int slot) { return "Mod Slot " + juce::String(slot + 1) + " Source"; }
+auto getModSlotTargetName(int slot) { return "Mod Slot " + juce::String(slot + 1) + " Target"; }
+auto getModSlotDepthName(int slot) { return "Mod Slot " + juce::String(slot + 1) + " Depth"; }
+
+auto getModSourceChoices()
+{
+    return juce::StringArray
+    {
+        "None",
+        "LFO 1",
+        "LFO 2",
+        "Envelope",
+        "Step Sequencer",
+    };
+}
+
+auto getModulationIntervalName() { return juce::String("Modulation Interval"); }
+
+auto getMorphName() { return juce::String("Morph"); }
+
+auto getModulationIntervalChoices()
+{
+    juce::StringArray choices;
+    for( int i = 0; i < 5; ++i )
+        choices.add(juce::String(Project13AudioProcessor::getModulationIntervalSamples(i)) + " samples");
+    
+    return choices;
+}
+
+/*
+ every float parameter of the chain, in the order the Mod Slot Target choices list them.
+ the modulators' own parameters aren't targets.
+ */
+juce::StringArray getModulationTargetNames()
+{
+    return
+    {
+        getPhaserRateName(),
+        getPhaserCenterFreqName(),
+        getPhaserDepthName(),
+        getPhaserFeedbackName(),
+        getPhaserMixName(),
+        
+        getChorusRateName(),
+        getChorusDepthName(),
+        getChorusCenterDelayName(),
+        getChorusFeedbackName(),
+        getChorusMixName(),
+        
+        getOverdriveSaturationName(),
+        getOverdriveMixName(),
+        
+        getLadderFilterCutoffName(),
+        getLadderFilterResonanceName(),
+        getLadderFilterDriveName(),
+        getLadderFilterMixName(),
+        
+        getGeneralFilterFreqName(),
+        getGeneralFilterQualityName(),
+        getGeneralFilterGainName(),
+        getGeneralFilterMixName(),
+        
+        getDelayTimeName(),
+        getDelayFeedbackName(),
+        getDelayMixName(),
+        
+        getGlobalMixName(),
+    };
+}
+
+/*
+ a literal, so the real-time checker can record it from inside malloc.
+ */
+const char* Project13AudioProcessor::getModuleName(DSP_Option option)
+{
+    switch (option)
+    {
+        case DSP_Option::Phase: return "Phaser";
+        case DSP_Option::Chorus: return "Chorus";
+        case DSP_Option::OverDrive: return "OverDrive";
+        case DSP_Option::LadderFilter: return "Ladder Filter";
+        case DSP_Option::GeneralFilter: return "General Filter";
+        case DSP_Option::Delay: return "Delay";
+        case DSP_Option::END_OF_LIST: break;
+    }
+    
+    return "";
+}
+
+/*
+ the parameters that configure each DSP_Option
+ */
+juce::StringArray getParamNamesFor(Project13AudioProcessor::DSP_Option option)
+{
+    using DSP_Option = Project13AudioProcessor::DSP_Option;
+    switch (option)
+    {
+        case DSP_Option::Phase:
+            return { getPhaserRateName(), getPhaserCenterFreqName(), getPhaserDepthName(), getPhaserFeedbackName(), getPhaserMixName(), getPhaserBypassName() };
+        case DSP_Option::Chorus:
+            return { getChorusRateName(), getChorusDepthName(), getChorusCenterDelayName(), getChorusFeedbackName(), getChorusMixName(), getChorusBypassName() };
+        case DSP_Option::OverDrive:
+            return { getOverdriveSaturationName(), getOverdriveCurveName(), getOverdriveMixName(), getOverdriveBypassName(), getOverdriveOversamplingName(), getOversamplingFilterName() };
+        case DSP_Option::LadderFilter:
+            return { getLadderFilterModeName(), getLadderFilterCutoffName(), getLadderFilterResonanceName(), getLadderFilterDriveName(), getLadderFilterMixName(), getLadderFilterBypassName(), getLadderFilterOversamplingName(), getOversamplingFilterName() };
+        case DSP_Option::GeneralFilter:
+            return { getGeneralFilterModeName(), getGeneralFilterFreqName(), getGeneralFilterQualityName(), getGeneralFilterGainName(), getGeneralFilterMixName(), getGeneralFilterBypassName() };
+        case DSP_Option::Delay:
+            return { getDelayTimeName(), getDelaySyncName(), getDelayNoteName(), getDelayFeedbackName(), getDelayMixName(), getDelayPingPongName(), getDelayBypassName() };
+        case DSP_Option::END_OF_LIST:
+            jassertfalse;
+            break;
+    }
+    
+    return {};
+}
 
 //==============================================================================
-Project13AudioProcessor::Project13AudioProcessor()
+Project13AudioProcessor::Project13AudioProcessor(const juce::File& presetBank)
 #ifndef JucePlugin_PreferredChannelConfigurations
      : AudioProcessor (BusesProperties()
                      #if ! JucePlugin_IsMidiEffect
@@ -76,8 +316,13 @@ Project13AudioProcessor::Project13AudioProcessor()
         DSP_Option::Chorus,
         DSP_Option::OverDrive,
         DSP_Option::LadderFilter,
+        DSP_Option::GeneralFilter,
+        DSP_Option::Delay,
     }};
     
+    dspChain = makeDSPChain(dspOrder);
+    publishDSPOrder(dspOrder);
+    
     auto floatParams = std::array
     {
         &phaserRateHz,
@@ -93,14 +338,29 @@ Project13AudioProcessor::Project13AudioProcessor()
         &chorusMixPercent,
         
         &overdriveSaturation,
+        &overdriveMixPercent,
         
         &ladderFilterCutoffHz,
         &ladderFilterResonance,
         &ladderFilterDrive,
+        &ladderFilterMixPercent,
         
         &generalFilterFreqHz,
         &generalFilterQuality,
         &generalFilterGain,
+        &generalFilterMixPercent,
+        
+        &delayTimeMs,
+        &delayFeedbackPercent,
+        &delayMixPercent,
+        
+        &globalMixPercent,
+        
+        &envelopeAttackMs,
+        &envelopeReleaseMs,
+        &stepSequencerRateHz,
+        
+        &morphPosition,
     };
     
     auto floatNameFuncs = std::array
@@ -118,14 +378,29 @@ Project13AudioProcessor::Project13AudioProcessor()
         &getChorusMixName,
         
         &getOverdriveSaturationName,
+        &getOverdriveMixName,
         
         &getLadderFilterCutoffName,
         &getLadderFilterResonanceName,
         &getLadderFilterDriveName,
+        &getLadderFilterMixName,
         
         &getGeneralFilterFreqName,
         &getGeneralFilterQualityName,
         &getGeneralFilterGainName,
+        &getGeneralFilterMixName,
+        
+        &getDelayTimeName,
+        &getDelayFeedbackName,
+        &getDelayMixName,
+        
+        &getGlobalMixName,
+        
+        &getEnvelopeAttackName,
+        &getEnvelopeReleaseName,
+        &getStepSequencerRateName,
+        
+        &getMorphName,
     };
     
     
@@ -145,6 +420,15 @@ Project13AudioProcessor::Project13AudioProcessor()
        &ladderFilterMode,
        
        &generalFilterMode,
+       
+       &overdriveCurve,
+       &overdriveOversampling,
+       &ladderFilterOversampling,
+       &oversamplingFilter,
+       
+       &delayNote,
+       
+       &modulationInterval,
    };
        
    auto choiceNameFuncs = std::array
@@ -152,6 +436,15 @@ Project13AudioProcessor::Project13AudioProcessor()
        &getLadderFilterModeName,
        
        &getGeneralFilterModeName,
+       
+       &getOverdriveCurveName,
+       &getOverdriveOversamplingName,
+       &getLadderFilterOversamplingName,
+       &getOversamplingFilterName,
+       
+       &getDelayNoteName,
+       
+       &getModulationIntervalName,
    };
        
    for( size_t i = 0; i < choiceParams.size(); ++i )
@@ -160,14 +453,142 @@ Project13AudioProcessor::Project13AudioProcessor()
        *ptrToParamPtr = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(choiceNameFuncs[i]()));
        jassert( *ptrToParamPtr != nullptr );
    }
+    
+    auto boolParams = std::array
+    {
+        &phaserBypass,
+        &chorusBypass,
+        &overdriveBypass,
+        &ladderFilterBypass,
+        &generalFilterBypass,
+        &delayBypass,
+        
+        &delaySync,
+        &delayPingPong,
+    };
+    
+    auto boolNameFuncs = std::array
+    {
+        &getPhaserBypassName,
+        &getChorusBypassName,
+        &getOverdriveBypassName,
+        &getLadderFilterBypassName,
+        &getGeneralFilterBypassName,
+        &getDelayBypassName,
+        
+        &getDelaySyncName,
+        &getDelayPingPongName,
+    };
+    
+    for( size_t i = 0; i < boolParams.size(); ++i )
+    {
+        auto ptrToParamPtr = boolParams[i];
+        *ptrToParamPtr = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(boolNameFuncs[i]()));
+        jassert( *ptrToParamPtr != nullptr );
+    }
 
+    //the indexed modulation parameters
+    for( size_t i = 0; i < lfoRateHz.size(); ++i )
+    {
+        lfoRateHz[i] = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(getLFORateName(static_cast<int>(i))));
+        jassert( lfoRateHz[i] != nullptr );
+        lfoShape[i] = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(getLFOShapeName(static_cast<int>(i))));
+        jassert( lfoShape[i] != nullptr );
+    }
+    
+    for( size_t i = 0; i < stepSequencerSteps.size(); ++i )
+    {
+        stepSequencerSteps[i] = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(getStepSequencerStepName(static_cast<int>(i))));
+        jassert( stepSequencerSteps[i] != nullptr );
+    }
+    
+    for( size_t i = 0; i < ModulationMatrix::numSlots; ++i )
+    {
+        auto slot = static_cast<int>(i);
+        modSlotSource[i] = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(getModSlotSourceName(slot)));
+        jassert( modSlotSource[i] != nullptr );
+        modSlotTarget[i] = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(getModSlotTargetName(slot)));
+        jassert( modSlotTarget[i] != nullptr );
+        modSlotDepth[i] = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(getModSlotDepthName(slot)));
+        jassert( modSlotDepth[i] != nullptr );
+    }
+    
+    for( auto& name : getModulationTargetNames() )
+    {
+        auto* target = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(name));
+        jassert( target != nullptr );
+        modulationTargets.push_back(target);
+        
+        auto module = DSP_Option::END_OF_LIST;
+        for( size_t i = 0; i < moduleParamListeners.size(); ++i )
+        {
+            if( getParamNamesFor(static_cast<DSP_Option>(i)).contains(name) )
+                module = static_cast<DSP_Option>(i);
+        }
+        
+        modulationTargetModules.push_back(module);
+    }
 
+    for( size_t i = 0; i < moduleParamListeners.size(); ++i )
+    {
+        for( auto& name : getParamNamesFor(static_cast<DSP_Option>(i)) )
+            apvts.addParameterListener(name, &moduleParamListeners[i]);
+    }
+    
+    //CCs set parameters on the audio thread, where the APVTS listeners aren't called.
+    for( auto* parameter : getParameters() )
+    {
+        juce::uint32 modules = 0;
+        if( auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter) )
+        {
+            for( size_t i = 0; i < moduleParamListeners.size(); ++i )
+            {
+                if( getParamNamesFor(static_cast<DSP_Option>(i)).contains(withID->paramID) )
+                    modules |= 1u << i;
+            }
+        }
+        
+        parameterModules.push_back(modules);
+        
+        auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter);
+        parameterIDHashes.push_back(withID != nullptr ? BinaryState::hashParameterID(withID->paramID) : 0);
+    }
+    
+    //saved states find their parameters by these, so two IDs must never share one.
+    auto sortedHashes = parameterIDHashes;
+    std::sort(sortedHashes.begin(), sortedHashes.end());
+    jassert( std::adjacent_find(sortedHashes.begin(), sortedHashes.end()) == sortedHashes.end() );
+    
+    parametersMovedOnAudioThread = std::vector<std::atomic<bool>>(parameterModules.size());
+    
+    //choices and toggles can't be interpolated, they switch at the crossover.
+    std::vector<Morpher::ParameterKind> morphKinds;
+    for( auto* parameter : getParameters() )
+    {
+        if( parameter == morphPosition )
+            morphKinds.push_back(Morpher::ParameterKind::Excluded);
+        else if( dynamic_cast<juce::AudioParameterFloat*>(parameter) != nullptr )
+            morphKinds.push_back(Morpher::ParameterKind::Continuous);
+        else
+            morphKinds.push_back(Morpher::ParameterKind::Discrete);
+    }
+    
+    snapshotMorpher.prepare(std::move(morphKinds), *morphPosition);
     
+    loadPrograms(presetBank);
     
+    startTimerHz(30);
 }
 
 Project13AudioProcessor::~Project13AudioProcessor()
 {
+    stopTimer();
+    
+    for( size_t i = 0; i < moduleParamListeners.size(); ++i )
+    {
+        for( auto& name : getParamNamesFor(static_cast<DSP_Option>(i)) )
+            apvts.removeParameterListener(name, &moduleParamListeners[i]);
+    }
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout Project13AudioProcessor::createParameterLayout()
@@ -219,6 +640,11 @@ juce::AudioProcessorValueTreeState::ParameterLayout Project13AudioProcessor::cre
                                                            juce::NormalisableRange<float>(0.01f, 1.f, 0.01f, 1.f),
                                                            0.05f,
                                                            "%"));
+    //bypass
+    name = getPhaserBypassName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint},
+                                                          name,
+                                                          false));
     
     /*
          Chorus:
@@ -264,11 +690,17 @@ juce::AudioProcessorValueTreeState::ParameterLayout Project13AudioProcessor::cre
                                                            juce::NormalisableRange<float>(0.01f, 1.f, 0.01f, 1.f),
                                                            0.05f,
                                                            "%"));
+    //bypass
+    name = getChorusBypassName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint},
+                                                          name,
+                                                          false));
     
     /*
      overdrive
-     uses the drive portion of the LadderFilter class for now
+     a static waveshaper, see Waveshaper.h
      drive: 1 - 100
+     curve: WaveshaperCurve enum (int)
      */
     
     //drive: 1-100
@@ -278,6 +710,30 @@ juce::AudioProcessorValueTreeState::ParameterLayout Project13AudioProcessor::cre
                                                            juce::NormalisableRange<float>(1.f, 100.f, 0.1f, 1.f),
                                                            1.f,
                                                            ""));
+    //curve: WaveshaperCurve enum (int)
+    name = getOverdriveCurveName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, versionHint},
+                                                            name,
+                                                            getOverdriveCurveChoices(),
+                                                            0));
+    //mix: 0 to 1
+    name = getOverdriveMixName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                           1.f,
+                                                           "%"));
+    //bypass
+    name = getOverdriveBypassName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint},
+                                                          name,
+                                                          false));
+    //oversampling: 1x - 8x
+    name = getOverdriveOversamplingName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, versionHint},
+                                                            name,
+                                                            getOversamplingChoices(),
+                                                            0));
     
     /*
          ladder filter:
@@ -316,6 +772,35 @@ juce::AudioProcessorValueTreeState::ParameterLayout Project13AudioProcessor::cre
                                                            juce::NormalisableRange<float>(1.f, 100.f, 0.1f, 1.f),
                                                            1.f,
                                                            ""));
+    //mix: 0 to 1
+    name = getLadderFilterMixName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                           1.f,
+                                                           "%"));
+    //bypass
+    name = getLadderFilterBypassName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint},
+                                                          name,
+                                                          false));
+    //oversampling: 1x - 8x
+    name = getLadderFilterOversamplingName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, versionHint},
+                                                            name,
+                                                            getOversamplingChoices(),
+                                                            0));
+    
+    /*
+     oversampling filter, shared by the overdrive and ladder filter:
+     polyphase IIR: low latency
+     linear phase FIR: more latency, no phase distortion
+     */
+    name = getOversamplingFilterName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, versionHint},
+                                                            name,
+                                                            getOversamplingFilterChoices(),
+                                                            0));
     
     /*
          general filter: https://docs.juce.com/develop/structdsp_1_1IIR_1_1Coefficients.html
@@ -350,9 +835,175 @@ juce::AudioProcessorValueTreeState::ParameterLayout Project13AudioProcessor::cre
                                                            name,
                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
                                                            0.0f));
+    //mix: 0 to 1
+    name = getGeneralFilterMixName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                           1.f,
+                                                           "%"));
+    //bypass
+    name = getGeneralFilterBypassName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint},
+                                                          name,
+                                                          false));
+    
+    /*
+         delay:
+         time: 1ms - 2000ms
+         sync: use the host tempo and 'note' instead of 'time'
+         note: 1/32 - 1/1, including dotted and triplets
+         feedback: 0 to 0.95
+         mix: 0 to 1
+         ping pong: bool
+         */
+    
+    //time: 1ms - 2000ms
+    name = getDelayTimeName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(BlockDelay::minDelayMs, BlockDelay::maxDelayMs, 0.1f, 0.4f),
+                                                           250.f,
+                                                           "ms"));
+    //sync: bool
+    name = getDelaySyncName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint},
+                                                          name,
+                                                          false));
+    //note: 1/32 - 1/1
+    name = getDelayNoteName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, versionHint},
+                                                            name,
+                                                            getDelayNoteChoices(),
+                                                            8));
+    //feedback: 0 to 0.95
+    name = getDelayFeedbackName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(0.f, 0.95f, 0.01f, 1.f),
+                                                           0.3f,
+                                                           "%"));
+    //mix: 0 to 1
+    name = getDelayMixName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                           0.f,
+                                                           "%"));
+    //ping pong: bool
+    name = getDelayPingPongName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint},
+                                                          name,
+                                                          false));
+    //bypass
+    name = getDelayBypassName();
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{name, versionHint},
+                                                          name,
+                                                          false));
     
     
 
+    /*
+     global mix: the whole chain against the latency compensated input
+     */
+    name = getGlobalMixName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                           1.f,
+                                                           "%"));
+    
+    /*
+     modulation, see Modulation.h
+     LFOs: rate 0.01 - 20 Hz, bipolar shapes
+     envelope follower: attack and release in ms, follows the chain's input
+     step sequencer: 8 steps of -1 to 1, in steps per second
+     mod slots: source -> target, depth -1 to 1 of the target's range
+     interval: how often the modulators are evaluated, in samples
+     */
+    for( int lfo = 0; lfo < 2; ++lfo )
+    {
+        name = getLFORateName(lfo);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                               name,
+                                                               juce::NormalisableRange<float>(0.01f, 20.f, 0.01f, 0.3f),
+                                                               1.f,
+                                                               "Hz"));
+        name = getLFOShapeName(lfo);
+        layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, versionHint},
+                                                                name,
+                                                                getLFOShapeChoices(),
+                                                                0));
+    }
+    
+    //attack: 0.1ms - 500ms
+    name = getEnvelopeAttackName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(0.1f, 500.f, 0.1f, 0.3f),
+                                                           10.f,
+                                                           "ms"));
+    //release: 1ms - 2000ms
+    name = getEnvelopeReleaseName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(1.f, 2000.f, 1.f, 0.3f),
+                                                           200.f,
+                                                           "ms"));
+    //rate: 0.1 - 32 steps per second
+    name = getStepSequencerRateName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(0.1f, 32.f, 0.01f, 0.5f),
+                                                           4.f,
+                                                           "Hz"));
+    //steps: -1 to 1
+    for( int step = 0; step < StepSequencer::numSteps; ++step )
+    {
+        name = getStepSequencerStepName(step);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                               name,
+                                                               juce::NormalisableRange<float>(-1.f, 1.f, 0.01f, 1.f),
+                                                               0.f,
+                                                               ""));
+    }
+    
+    for( int slot = 0; slot < static_cast<int>(ModulationMatrix::numSlots); ++slot )
+    {
+        name = getModSlotSourceName(slot);
+        layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, versionHint},
+                                                                name,
+                                                                getModSourceChoices(),
+                                                                0));
+        name = getModSlotTargetName(slot);
+        layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, versionHint},
+                                                                name,
+                                                                getModulationTargetNames(),
+                                                                0));
+        //depth: -1 to 1, of the target's normalised range
+        name = getModSlotDepthName(slot);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                               name,
+                                                               juce::NormalisableRange<float>(-1.f, 1.f, 0.01f, 1.f),
+                                                               0.f,
+                                                               ""));
+    }
+    
+    //interval: 8 - 128 samples
+    name = getModulationIntervalName();
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{name, versionHint},
+                                                            name,
+                                                            getModulationIntervalChoices(),
+                                                            2));
+    
+    //morph: 0 - 1, across the captured snapshots
+    name = getMorphName();
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{name, versionHint},
+                                                           name,
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.001f, 1.f),
+                                                           0.f,
+                                                           ""));
+    
     return layout;
 }
 
@@ -389,33 +1040,90 @@ bool Project13AudioProcessor::isMidiEffect() const
    #endif
 }
 
+/*
+ the order and the module settings belong to the audio thread, so the tail is worked out
+ there and only read here.
+ */
 double Project13AudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return chainTailSeconds.load();
 }
 
 int Project13AudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return programs.names.size();   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                                    // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int Project13AudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load();
 }
 
 void Project13AudioProcessor::setCurrentProgram (int index)
 {
+    if( ! juce::isPositiveAndBelow(index, programs.names.size()) )
+        return;
+    
+    //without a bank the one program is whatever the session holds: picking it changes nothing.
+    currentProgram.store(index);
+    if( programs.values.empty() )
+        return;
+    
+    //applied by the audio thread at its next sub-block boundary, see updateProgram().
+    pendingProgram.store(index);
 }
 
 const juce::String Project13AudioProcessor::getProgramName (int index)
 {
-    return {};
+    return programs.names[index];
 }
 
 void Project13AudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    //the bank is read only.
+    juce::ignoreUnused(index, newName);
+}
+
+juce::File Project13AudioProcessor::getPresetBankFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile(JucePlugin_Name)
+        .getChildFile("Presets.p13bank");
+}
+
+/*
+ the bank is rewritten whole: it's small, and a half-written file would lose every preset.
+ the presets already in it are re-encoded, which also brings them up to the current BinaryState version.
+ */
+bool Project13AudioProcessor::savePreset(const juce::String& name, const juce::File& bank)
+{
+    if( name.isEmpty() )
+        return false;
+    
+    std::vector<PresetBank::Preset> presets;
+    if( bank.existsAsFile() )
+    {
+        auto loaded = PresetBank::load(bank, [&presets, &name](const juce::String& presetName, const BinaryState& state)
+        {
+            if( presetName == name )
+                return;
+            
+            PresetBank::Preset preset { presetName, {} };
+            state.write(preset.state);
+            presets.push_back(std::move(preset));
+        });
+        
+        //never overwrite a bank that couldn't be read.
+        if( ! loaded )
+            return false;
+    }
+    
+    PresetBank::Preset preset { name, {} };
+    writeState(preset.state, StateFormat::Binary);
+    presets.push_back(std::move(preset));
+    
+    return bank.getParentDirectory().createDirectory().wasOk() && PresetBank::save(bank, presets);
 }
 
 //==============================================================================
@@ -424,25 +1132,73 @@ void Project13AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
     
+    //the chain only ever sees sub-blocks, whatever size the host's blocks are.
+    juce::ignoreUnused(samplesPerBlock);
+    const auto maxSubBlockSize = juce::jmax(1, subBlockSize.load());
+    subBlockScheduler.prepare(maxSubBlockSize);
+    samplesUntilModulation = 0;
+    silenceDetector.reset();
+    
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
+    spec.maximumBlockSize = static_cast<juce::uint32>(maxSubBlockSize);
     spec.numChannels = getTotalNumInputChannels();
     
+    //the stage functions are specialised for the bus layout.
+    chainNumChannels = spec.numChannels;
+    dspChain = makeDSPChain(dspOrder);
+    
+    //a 2nd order passthrough, so the filter state is sized for the biquads
+    //the coefficient generator makes and never reallocates on the audio thread.
+    *generalFilter.dsp.state = juce::dsp::IIR::Coefficients<float>(1.f, 0.f, 0.f, 1.f, 0.f, 0.f);
+    //the filter starts with the right coefficients rather than passing through until the generator catches up.
+    FilterCoefficientGenerator::makeCoefficients(getGeneralFilterParams(sampleRate), *generalFilter.dsp.state);
+    
     std::vector<juce::dsp::ProcessorBase*> dsp
     {
         &phaser,
         &chorus,
         &overdrive,
         &ladderFilter,
-        &generalFilter
+        &generalFilter,
+        &delay
     };
     
+    auto filter = static_cast<OversamplingFilter>(oversamplingFilter->getIndex());
+    overdrive.dsp.setOversampling(getOversamplingFactorLog2(*overdriveOversampling), filter);
+    ladderFilter.dsp.setOversampling(getOversamplingFactorLog2(*ladderFilterOversampling), filter);
+    
     for( auto p : dsp )
     {
         p->prepare(spec);
         p->reset();
     }
+    
+    pendingLatencySamples.store(getChainLatencySamples());
+    setLatencySamples(pendingLatencySamples.load());
+    
+    //program changes, morph crossovers and order changes fade out and back in over 5ms.
+    switchFade.reset(sampleRate, 0.005);
+    switchFade.setCurrentAndTargetValue(fadingToProgram >= 0 || morphFramePending || dspOrderPending ? 0.f : 1.f);
+    
+    auto maxChainLatency = overdrive.dsp.getMaxLatencyInSamples() + ladderFilter.dsp.getMaxLatencyInSamples();
+    globalDryDelay.setMaximumDelayInSamples(maxChainLatency + 1);
+    globalDryDelay.prepare(spec);
+    globalDryDelay.reset();
+    globalDryBuffer.setSize(static_cast<int>(spec.numChannels), maxSubBlockSize);
+    globalMix.prepare(sampleRate, maxSubBlockSize);
+    globalMix.setCurrentAndTargetWetGain(globalMixPercent->get());
+    
+    modulation.prepare(sampleRate);
+    modulatedModules = {};
+    
+    stageMeters.prepare(sampleRate);
+    stageProfiler.prepare(sampleRate);
+    preChainSpectrum.prepare(sampleRate);
+    postChainSpectrum.prepare(sampleRate);
+    
+    markAllModulesDirty();
+    updateTail();
 }
 
 void Project13AudioProcessor::releaseResources()
@@ -480,6 +1236,9 @@ bool Project13AudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 void Project13AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    //test builds record anything that could block from here on, see RealtimeCheck.h.
+    const RealtimeCheck::ScopedRealtime realtime;
+    stageProfiler.beginBlock();
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -492,79 +1251,1016 @@ void Project13AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
     
-    phaser.dsp.setRate( phaserRateHz->get() );
-    phaser.dsp.setCentreFrequency( phaserCenterFreqHz->get() );
-    phaser.dsp.setDepth( phaserDepthPercent->get() );
-    phaser.dsp.setFeedback( phaserFeedbackPercent->get() );
-    phaser.dsp.setMix( phaserMixPercent->get() );
+    updateHostTempo();
+    
+    auto block = juce::dsp::AudioBlock<float>(buffer);
+    stageMeters.measure(inputMeterPoint, block);
+    
+    const auto analyseSpectrum = spectrumAnalyserThread.hasViewers();
+    if( analyseSpectrum )
+        preChainSpectrum.push(block);
+    
+    if( shouldSleep(block) )
+    {
+        processAsleep(block, midiMessages);
+    }
+    else
+    {
+        //parameter, modulation and order updates happen at sub-block boundaries, whatever the host's block size.
+        auto processSegment = [this](juce::dsp::AudioBlock<float> segment)
+        {
+            subBlockScheduler.process(segment,
+                                      [this]() { return beginSubBlock(); },
+                                      [this](juce::dsp::AudioBlock<float>& subBlock) { processSubBlock(subBlock); });
+        };
+        
+        /*
+         the block is split at each CC, so the parameter changes on the CC's sample.
+         CCs less than ccCoalesceSamples after the first of a run are applied together at the
+         last one's sample, so a controller flooding CCs costs at most one split per
+         ccCoalesceSamples, and no CC takes effect before its own sample.
+         */
+        const auto numSamples = block.getNumSamples();
+        size_t position = 0;
+        
+        auto runBegin = midiMessages.begin();
+        size_t runStart = 0, runEnd = 0;
+        bool runPending = false;
+        
+        auto applyRun = [&](const juce::MidiBufferIterator& end)
+        {
+            if( runEnd > position )
+            {
+                processSegment(block.getSubBlock(position, runEnd - position));
+                position = runEnd;
+            }
+            
+            bool changed = false;
+            for( auto it = runBegin; it != end; ++it )
+            {
+                auto message = (*it).getMessage();
+                if( message.isController() )
+                    changed = applyMidiController(message) || changed;
+            }
+            
+            //a new sub-block starts here, so updateDSPFromParams() sees the new values.
+            if( changed )
+                subBlockScheduler.reset();
+        };
+        
+        for( auto it = midiMessages.begin(); it != midiMessages.end(); ++it )
+        {
+            const auto metadata = *it;
+            if( ! metadata.getMessage().isController() )
+                continue;
+            
+            auto eventPosition = static_cast<size_t>(juce::jlimit(0, static_cast<int>(numSamples), metadata.samplePosition));
+            if( runPending && eventPosition >= runStart + ccCoalesceSamples )
+            {
+                applyRun(it);
+                runPending = false;
+            }
+            
+            if( ! runPending )
+            {
+                runBegin = it;
+                runStart = eventPosition;
+                runPending = true;
+            }
+            
+            runEnd = eventPosition;
+        }
+        
+        if( runPending )
+            applyRun(midiMessages.end());
+        
+        if( position < numSamples )
+            processSegment(block.getSubBlock(position, numSamples - position));
+    }
+    
+    stageMeters.measure(outputMeterPoint, block);
+    
+    if( analyseSpectrum )
+        postChainSpectrum.push(block);
+    
+    //for the next block's shouldSleep(), from the settings this one ended with.
+    updateTail();
+    
+    stageMeters.advance(buffer.getNumSamples());
+    stageProfiler.endBlock(buffer.getNumSamples());
+}
+
+/*
+ called by the scheduler at each sub-block boundary. returns the sub-block's length.
+ */
+int Project13AudioProcessor::beginSubBlock()
+{
+    updateDSPOrder();
+    updateSwitches();
+    
+    auto length = subBlockScheduler.getMaxSubBlockSize();
+    
+    //the modulators step once per control interval, which can be shorter or longer than a sub-block.
+    //with no mod slot in use they just keep time.
+    if( ! isModulationInUse() )
+    {
+        updateModulation(length);
+        samplesUntilModulation = 0;
+    }
+    else
+    {
+        if( samplesUntilModulation == 0 )
+        {
+            samplesUntilModulation = getModulationIntervalSamples();
+            updateModulation(samplesUntilModulation);
+        }
+        
+        length = juce::jmin(length, samplesUntilModulation);
+        samplesUntilModulation -= length;
+    }
+    
+    updateDSPFromParams();
+    
+    return length;
+}
+
+void Project13AudioProcessor::processSubBlock(juce::dsp::AudioBlock<float>& block)
+{
+    //the envelope follower listens to the chain's input.
+    modulation.envelope.process(block);
+    
+    globalMix.setWetGain(getModulatedValue(globalMixPercent));
+    
+    //sub-blocks always fit the buffers prepareToPlay() made.
+    jassert( block.getNumSamples() <= static_cast<size_t>(globalDryBuffer.getNumSamples()) );
+    
+    //fully wet: the dry path is skipped entirely.
+    auto mixWithDry = globalMix.isSmoothing() || globalMix.getTargetWetGain() < 1.f;
+    if( mixWithDry )
+        pushGlobalDry(block);
+    
+    processChain(block, dspChain);
+    
+    if( mixWithDry )
+        mixGlobalDry(block);
     
-    chorus.dsp.setRate( chorusRateHz->get() );
-    chorus.dsp.setDepth( chorusDepthPercent->get() );
-    chorus.dsp.setCentreDelay( chorusCenterDelayMs->get() );
-    chorus.dsp.setFeedback( chorusFeedbackPercent->get() );
-    chorus.dsp.setMix( chorusMixPercent->get() );
+    if( switchFade.isSmoothing() || switchFade.getCurrentValue() < 1.f )
+        applySwitchFade(block);
+}
+
+/*
+ the chain sleeps through silent input once every tail in it has decayed below the
+ silence threshold. switches mid fade finish first, so nothing is left half done.
+ */
+bool Project13AudioProcessor::shouldSleep(const juce::dsp::AudioBlock<float>& block)
+{
+    if( ! sleepWhenSilent.load() || ! silenceDetector.process(block) )
+        return false;
+    
+    auto tailSamples = static_cast<juce::int64>(std::ceil(chainTailSeconds.load() * getSampleRate()));
+    return silenceDetector.getSilentSamplesBefore() >= tailSamples && ! isSwitching();
+}
+
+bool Project13AudioProcessor::isSwitching() const
+{
+    return fadingToProgram >= 0
+        || morphFramePending
+        || switchFade.isSmoothing()
+        || switchFade.getTargetValue() < 1.f
+        || dspOrderPending;
+}
+
+/*
+ the chain would only output silence, so the output is cleared instead. what arrives while
+ asleep is applied straight away, without fades, since nothing is sounding: programs, morph
+ frames, orders and mapped CCs. the modulators keep time, so waking picks up where they'd be.
+ */
+void Project13AudioProcessor::processAsleep(juce::dsp::AudioBlock<float>& block, const juce::MidiBuffer& midiMessages)
+{
+    block.clear();
+    
+    if( auto index = pendingProgram.exchange(-1); index >= 0 )
+        applyProgram(index);
+    
+    if( snapshotMorpher.frames.pull() )
+        applyMorphFrame(snapshotMorpher.frames.getReadBuffer());
+    
+    updateDSPOrder();
+    if( dspOrderPending )
+    {
+        applyDSPOrder(pendingDSPOrder);
+        dspOrderPending = false;
+    }
+    
+    for( const auto metadata : midiMessages )
+    {
+        auto message = metadata.getMessage();
+        if( message.isController() )
+            applyMidiController(message);
+    }
+    
+    //the envelope follower hears the silence too.
+    modulation.envelope.process(block);
+    updateModulation(static_cast<int>(block.getNumSamples()));
+    samplesUntilModulation = 0;
+    
+    //waking starts a new sub-block, so it picks up everything above.
+    subBlockScheduler.reset();
+}
+
+/*
+ estimates from the modules' current settings. a bypassed module has no tail of its own:
+ what it passes through is delayed by its latency, which updateTail() adds once.
+ */
+ModuleTail Project13AudioProcessor::getModuleTail(DSP_Option option) const
+{
+    switch (option)
+    {
+        case DSP_Option::Phase:
+        {
+            if( phaser.isBypassed() )
+                break;
+            
+            //6 first order allpasses, each delaying low frequencies by about 1 / (pi f) at the sweep's lowest f.
+            auto lowestHz = juce::jmax(20.f, getModulatedValue(phaserCenterFreqHz) * (1.f - getModulatedValue(phaserDepthPercent)));
+            auto loopSeconds = 6.0 / (juce::MathConstants<double>::pi * lowestHz);
+            return ModuleTail::feedbackLoop(loopSeconds, getModulatedValue(phaserFeedbackPercent));
+        }
+        case DSP_Option::Chorus:
+        {
+            if( chorus.isBypassed() )
+                break;
+            
+            //juce::dsp::Chorus modulates the delay by up to 10ms at full depth.
+            auto loopMs = getModulatedValue(chorusCenterDelayMs) + 10.f * getModulatedValue(chorusDepthPercent);
+            return ModuleTail::feedbackLoop(loopMs / 1000.0, getModulatedValue(chorusFeedbackPercent));
+        }
+        case DSP_Option::OverDrive:
+        {
+            if( overdrive.isBypassed() )
+                break;
+            
+            //no memory, but quiet input comes out drive times louder.
+            auto mix = getModulatedValue(overdriveMixPercent);
+            ModuleTail tail;
+            tail.gainDb = juce::Decibels::gainToDecibels(1.f - mix + mix * getModulatedValue(overdriveSaturation));
+            return tail;
+        }
+        case DSP_Option::LadderFilter:
+        {
+            if( ladderFilter.isBypassed() )
+                break;
+            
+            //self oscillates at a resonance of 1.
+            auto q = 0.5 / juce::jmax(1.0 - getModulatedValue(ladderFilterResonance), 0.001);
+            auto tail = ModuleTail::resonance(getModulatedValue(ladderFilterCutoffHz), q);
+            tail.gainDb = juce::jmax(0.0, juce::Decibels::gainToDecibels(q));
+            return tail;
+        }
+        case DSP_Option::GeneralFilter:
+        {
+            if( generalFilter.isBypassed() )
+                break;
+            
+            auto tail = ModuleTail::resonance(getModulatedValue(generalFilterFreqHz), getModulatedValue(generalFilterQuality));
+            if( static_cast<GeneralFilterMode>(generalFilterMode->getIndex()) == GeneralFilterMode::Peak )
+                tail.gainDb = getModulatedValue(generalFilterGain);
+            
+            return tail;
+        }
+        case DSP_Option::Delay:
+        {
+            if( delay.isBypassed() )
+                break;
+            
+            //the delay's own time, which follows the host's tempo when synced.
+            return ModuleTail::feedbackLoop(delay.dsp.getDelayTimeMs() / 1000.0, delay.dsp.getFeedback());
+        }
+        case DSP_Option::END_OF_LIST:
+            break;
+    }
     
-    overdrive.dsp.setDrive( overdriveSaturation->get() );
+    return {};
+}
+
+std::array<ModuleTail, static_cast<size_t>(Project13AudioProcessor::DSP_Option::END_OF_LIST)> Project13AudioProcessor::getSlotTails(const DSP_Order& order) const
+{
+    std::array<ModuleTail, static_cast<size_t>(DSP_Option::END_OF_LIST)> slots;
+    for( size_t i = 0; i < slots.size(); ++i )
+        slots[i] = getModuleTail(order[i]);
     
-    ladderFilter.dsp.setMode( static_cast<juce::dsp::LadderFilterMode>(ladderFilterMode->getIndex()));
-    ladderFilter.dsp.setCutoffFrequencyHz( ladderFilterCutoffHz->get() );
-    ladderFilter.dsp.setResonance( ladderFilterResonance->get() );
-    ladderFilter.dsp.setDrive( ladderFilterDrive->get() );
+    return slots;
+}
 
+/*
+ a handful of logs and powers, cheap enough for every block: the chain's gain has to be
+ known before a block can be called silent.
+ */
+void Project13AudioProcessor::updateTail()
+{
+    const auto sampleRate = getSampleRate();
+    const auto slots = getSlotTails(dspOrder);
+    
+    silenceDetector.setChainGainDb(getChainGainDb(slots));
     
+    //from full scale down to the silence threshold.
+    auto decayDb = -static_cast<double>(SilenceDetector::thresholdDb);
+    chainTailSeconds.store(sampleRate > 0.0 ? getChainTailSeconds(slots, decayDb) + getChainLatencySamples() / sampleRate : 0.0);
+}
+
+void Project13AudioProcessor::updateDSPOrder()
+{
     auto newDSPOrder = DSP_Order();
+    bool pulledNewOrder = false;
     
     //try to pull
     while( dspOrderFifo.pull(newDSPOrder) )
     {
+        pulledNewOrder = true;
+    }
+    
+    //if you pulled, it waits for updateSwitches() to fade the output out, unless it can switch straight away.
+    if( pulledNewOrder )
+    {
+        pendingDSPOrder = newDSPOrder;
+        dspOrderPending = newDSPOrder != dspOrder;
         
+        if( dspOrderPending && ! crossfadeOrderChanges.load() )
+        {
+            applyDSPOrder(pendingDSPOrder);
+            dspOrderPending = false;
+        }
     }
+}
+
+/*
+ replaces dspOrder and rebuilds the cached chain, straight away.
+ only called while the output is faded out, or while nothing is sounding.
+ */
+void Project13AudioProcessor::applyDSPOrder(const DSP_Order& newDSPOrder)
+{
+    if( newDSPOrder == dspOrder )
+        return;
+    
+    dspOrder = newDSPOrder;
+    dspChain = makeDSPChain(dspOrder);
+    publishDSPOrder(dspOrder);
+}
+
+void Project13AudioProcessor::publishDSPOrder(const DSP_Order& order)
+{
+    static_assert(static_cast<size_t>(DSP_Option::END_OF_LIST) <= 16 && std::tuple_size_v<DSP_Order> * 4 <= 32);
+    
+    juce::uint32 packed = 0;
+    for( size_t i = 0; i < order.size(); ++i )
+        packed |= static_cast<juce::uint32>(order[i]) << (i * 4);
     
-    //if you pulled, replace dspOrder
-    if( newDSPOrder != DSP_Order() )
-        dspOrder = newDSPOrder;
+    publishedDSPOrder.store(packed);
+}
+
+Project13AudioProcessor::DSP_Order Project13AudioProcessor::getDSPOrder() const
+{
+    const auto packed = publishedDSPOrder.load();
     
-    //now convert dspOrder into an array of pointers.
-    DSP_Pointers dspPointers;
+    DSP_Order order;
+    for( size_t i = 0; i < order.size(); ++i )
+        order[i] = static_cast<DSP_Option>((packed >> (i * 4)) & 0xf);
     
-    for(size_t i = 0; i < dspPointers.size(); ++i )
+    return order;
+}
+
+Project13AudioProcessor::DSP_Pointers Project13AudioProcessor::getDSPPointers(const DSP_Order& order)
+{
+    DSP_Pointers pointers;
+    pointers.fill(nullptr);
+    
+    for(size_t i = 0; i < pointers.size(); ++i )
     {
-        switch (dspOrder[i])
+        switch (order[i])
         {
             case DSP_Option::Phase:
-                dspPointers[i] = &phaser;
+                pointers[i] = &phaser;
                 break;
             case DSP_Option::Chorus:
-                dspPointers[i] = &chorus;
+                pointers[i] = &chorus;
                 break;
             case DSP_Option::OverDrive:
-                dspPointers[i] = &overdrive;
+                pointers[i] = &overdrive;
                 break;
             case DSP_Option::LadderFilter:
-                dspPointers[i] = &ladderFilter;
+                pointers[i] = &ladderFilter;
                 break;
             case DSP_Option::GeneralFilter:
-                dspPointers[i] = &generalFilter;
+                pointers[i] = &generalFilter;
+                break;
+            case DSP_Option::Delay:
+                pointers[i] = &delay;
                 break;
             case DSP_Option::END_OF_LIST:
-                jassertfalse;
+                //an empty slot
                 break;
         }
     }
     
-    //now process
-    auto block = juce::dsp::AudioBlock<float>(buffer);
+    return pointers;
+}
+
+Project13AudioProcessor::DSP_Chain Project13AudioProcessor::makeDSPChain(const DSP_Order& order)
+{
+    DSP_Chain chain;
+    chain.order = order;
+    chain.pointers = getDSPPointers(order);
+    
+    chain.hasStages = true;
+    for( size_t i = 0; i < order.size(); ++i )
+    {
+        chain.stages[i] = getStageFunction(order[i], chainNumChannels);
+        chain.hasStages = chain.hasStages && chain.stages[i] != nullptr;
+    }
+    
+    return chain;
+}
+
+void Project13AudioProcessor::processChain(juce::dsp::AudioBlock<float>& block, const DSP_Chain& chain)
+{
     auto context = juce::dsp::ProcessContextReplacing<float>(block);
     
-    for(size_t i = 0; i < dspPointers.size(); ++i )
+    if( chain.hasStages && useStaticDispatch.load() && block.getNumChannels() == chainNumChannels )
+    {
+        for( size_t i = 0; i < chain.stages.size(); ++i )
+            chain.stages[i](*this, context, i);
+        
+        return;
+    }
+    
+    auto& pointers = chain.pointers;
+    for(size_t i = 0; i < pointers.size(); ++i )
+    {
+        if( pointers[i] != nullptr )
+        {
+            const RealtimeCheck::ScopedSlot slot(static_cast<int>(i), getModuleName(chain.order[i]));
+            const Profiler::ScopedStage stage(stageProfiler, static_cast<size_t>(chain.order[i]));
+            pointers[i]->process(context);
+        }
+        
+        stageMeters.measure(getSlotMeterPoint(i), block);
+    }
+}
+
+//==============================================================================
+/*
+ calls the concrete DSP_Choice directly so the compiler can inline it into the chain.
+ */
+template<Project13AudioProcessor::DSP_Option Option, size_t NumChannels>
+void Project13AudioProcessor::processStage(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    if constexpr ( Option == DSP_Option::Phase )
+        phaser.processDirect<NumChannels>(context);
+    else if constexpr ( Option == DSP_Option::Chorus )
+        chorus.processDirect<NumChannels>(context);
+    else if constexpr ( Option == DSP_Option::OverDrive )
+        overdrive.processDirect<NumChannels>(context);
+    else if constexpr ( Option == DSP_Option::LadderFilter )
+        ladderFilter.processDirect<NumChannels>(context);
+    else if constexpr ( Option == DSP_Option::GeneralFilter )
+        generalFilter.processDirect<NumChannels>(context);
+    else if constexpr ( Option == DSP_Option::Delay )
+        delay.processDirect<NumChannels>(context);
+}
+
+template<Project13AudioProcessor::DSP_Option Option, size_t NumChannels>
+void Project13AudioProcessor::processStaticStage(Project13AudioProcessor& processor, const juce::dsp::ProcessContextReplacing<float>& context, size_t slot)
+{
+    {
+        const RealtimeCheck::ScopedSlot scopedSlot(static_cast<int>(slot), getModuleName(Option));
+        const Profiler::ScopedStage stage(processor.stageProfiler, static_cast<size_t>(Option));
+        processor.processStage<Option, NumChannels>(context);
+    }
+    
+    processor.stageMeters.measure<NumChannels>(getSlotMeterPoint(slot), context.getOutputBlock());
+}
+
+Project13AudioProcessor::StageFunction Project13AudioProcessor::getStageFunction(DSP_Option option, size_t numChannels)
+{
+    //one instantiation of processStaticStage per DSP_Option and channel count, built at compile time.
+    constexpr auto makeStageFunctions = []<size_t NumChannels>()
+    {
+        return []<size_t... Options>(std::index_sequence<Options...>)
+        {
+            return std::array<StageFunction, sizeof...(Options)> { &processStaticStage<static_cast<DSP_Option>(Options), NumChannels>... };
+        }(std::make_index_sequence<static_cast<size_t>(DSP_Option::END_OF_LIST)>());
+    };
+    
+    static constexpr auto monoStageFunctions = makeStageFunctions.template operator()<1>();
+    static constexpr auto stereoStageFunctions = makeStageFunctions.template operator()<2>();
+    
+    const auto index = static_cast<size_t>(option);
+    if( index >= monoStageFunctions.size() || (numChannels != 1 && numChannels != 2) )
+        return nullptr;
+    
+    return numChannels == 1 ? monoStageFunctions[index] : stereoStageFunctions[index];
+}
+
+/*
+ while the global mix is fully wet the delay isn't fed, so right after the mix moves
+ it still holds up to one chain latency of older input. the ramp from fully wet hides it.
+ */
+void Project13AudioProcessor::pushGlobalDry(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(globalDryBuffer.getNumChannels()));
+    auto dry = juce::dsp::AudioBlock<float>(globalDryBuffer)
+                    .getSubsetChannelBlock(0, numChannels)
+                    .getSubBlock(0, block.getNumSamples());
+    dry.copyFrom(block);
+    
+    auto latency = getChainLatencySamples();
+    if( latency != globalDryDelaySamples )
+    {
+        globalDryDelaySamples = latency;
+        globalDryDelay.setDelay(static_cast<float>(latency));
+    }
+    
+    if( globalDryDelaySamples > 0 )
+        globalDryDelay.process(juce::dsp::ProcessContextReplacing<float>(dry));
+}
+
+void Project13AudioProcessor::mixGlobalDry(juce::dsp::AudioBlock<float>& block)
+{
+    const auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(globalDryBuffer.getNumChannels()));
+    auto dry = juce::dsp::AudioBlock<float>(globalDryBuffer)
+                    .getSubsetChannelBlock(0, numChannels)
+                    .getSubBlock(0, block.getNumSamples());
+    
+    globalMix.process(block, dry);
+}
+
+void Project13AudioProcessor::markAllModulesDirty()
+{
+    for( auto& listener : moduleParamListeners )
+        listener.dirty.store(true);
+}
+
+bool Project13AudioProcessor::isModulationInUse() const
+{
+    for( size_t i = 0; i < modSlotSource.size(); ++i )
+    {
+        if( modSlotSource[i]->getIndex() != static_cast<int>(ModulationSource::None) && modSlotDepth[i]->get() != 0.f )
+            return true;
+    }
+    
+    return false;
+}
+
+int Project13AudioProcessor::getModulationIntervalSamples() const
+{
+    return getModulationIntervalSamples(modulationInterval->getIndex());
+}
+
+double Project13AudioProcessor::getModulationIntervalSeconds() const
+{
+    return getSampleRate() > 0.0 ? getModulationIntervalSamples() / getSampleRate() : 0.0;
+}
+
+/*
+ steps the modulators to the start of the next control interval, numSamples long,
+ and flags the modules they target so updateDSPFromParams() picks up the new values.
+ */
+void Project13AudioProcessor::updateModulation(int numSamples)
+{
+    for( size_t i = 0; i < modulation.lfos.size(); ++i )
+    {
+        modulation.lfos[i].setRateHz( lfoRateHz[i]->get() );
+        modulation.lfos[i].setShape( static_cast<LFOShape>(lfoShape[i]->getIndex()) );
+    }
+    
+    modulation.envelope.setAttackMs( envelopeAttackMs->get() );
+    modulation.envelope.setReleaseMs( envelopeReleaseMs->get() );
+    
+    modulation.stepSequencer.setRateHz( stepSequencerRateHz->get() );
+    for( size_t i = 0; i < stepSequencerSteps.size(); ++i )
+        modulation.stepSequencer.setStep( static_cast<int>(i), stepSequencerSteps[i]->get() );
+    
+    std::array<ModulationMatrix::Slot, ModulationMatrix::numSlots> slots;
+    for( size_t i = 0; i < slots.size(); ++i )
+    {
+        auto target = static_cast<size_t>(modSlotTarget[i]->getIndex());
+        slots[i].source = static_cast<ModulationSource>(modSlotSource[i]->getIndex());
+        slots[i].target = target < modulationTargets.size() ? modulationTargets[target] : nullptr;
+        slots[i].depth = modSlotDepth[i]->get();
+    }
+    
+    modulation.update(slots, numSamples);
+    
+    //modules modulated in the last interval are updated once more, to go back to their parameters' values.
+    std::array<bool, static_cast<size_t>(DSP_Option::END_OF_LIST)> modulatedNow {};
+    for( size_t i = 0; i < modulationTargets.size(); ++i )
+    {
+        auto module = modulationTargetModules[i];
+        if( module != DSP_Option::END_OF_LIST && modulation.isModulating(modulationTargets[i]) )
+            modulatedNow[static_cast<size_t>(module)] = true;
+    }
+    
+    for( size_t i = 0; i < modulatedNow.size(); ++i )
+    {
+        if( modulatedNow[i] || modulatedModules[i] )
+            moduleParamListeners[i].dirty.store(true);
+    }
+    
+    modulatedModules = modulatedNow;
+}
+
+void Project13AudioProcessor::updateDSPFromParams()
+{
+    //exchange() clears the flag before reading, so a change that lands mid-update is picked up next block.
+    if( getParamListener(DSP_Option::Phase).dirty.exchange(false) )
+    {
+        phaser.dsp.setRate( getModulatedValue(phaserRateHz) );
+        phaser.dsp.setCentreFrequency( getModulatedValue(phaserCenterFreqHz) );
+        phaser.dsp.setDepth( getModulatedValue(phaserDepthPercent) );
+        phaser.dsp.setFeedback( getModulatedValue(phaserFeedbackPercent) );
+        phaser.dsp.setMix( getModulatedValue(phaserMixPercent) );
+        
+        //the mix can't reach 0, its minimum is treated as 'no effect'.
+        auto isNeutral = getModulatedValue(phaserMixPercent) <= phaserMixPercent->range.start;
+        phaser.setBypassed( phaserBypass->get() || isNeutral );
+    }
+    
+    if( getParamListener(DSP_Option::Chorus).dirty.exchange(false) )
+    {
+        chorus.dsp.setRate( getModulatedValue(chorusRateHz) );
+        chorus.dsp.setDepth( getModulatedValue(chorusDepthPercent) );
+        chorus.dsp.setCentreDelay( getModulatedValue(chorusCenterDelayMs) );
+        chorus.dsp.setFeedback( getModulatedValue(chorusFeedbackPercent) );
+        chorus.dsp.setMix( getModulatedValue(chorusMixPercent) );
+        
+        auto isNeutral = getModulatedValue(chorusMixPercent) <= chorusMixPercent->range.start;
+        chorus.setBypassed( chorusBypass->get() || isNeutral );
+    }
+    
+    if( getParamListener(DSP_Option::OverDrive).dirty.exchange(false) )
+    {
+        overdrive.dsp.setOversampling(getOversamplingFactorLog2(*overdriveOversampling),
+                                      static_cast<OversamplingFilter>(oversamplingFilter->getIndex()));
+        
+        //modulated: glide over one control interval, so the steps between control values are interpolated.
+        overdrive.dsp.setDriveRampLength( modulation.isModulating(overdriveSaturation) ? getModulationIntervalSeconds() : Waveshaper::defaultDriveRampLengthSeconds );
+        overdrive.dsp.setDrive( getModulatedValue(overdriveSaturation) );
+        overdrive.dsp.setCurve( static_cast<WaveshaperCurve>(overdriveCurve->getIndex()) );
+        overdrive.setMix( getModulatedValue(overdriveMixPercent) );
+        
+        //no drive setting is neutral: every curve still shapes or clips at a drive of 1.
+        overdrive.setBypassed( overdriveBypass->get() );
+    }
+    
+    if( getParamListener(DSP_Option::LadderFilter).dirty.exchange(false) )
+    {
+        ladderFilter.dsp.setOversampling(getOversamplingFactorLog2(*ladderFilterOversampling),
+                                         static_cast<OversamplingFilter>(oversamplingFilter->getIndex()));
+        
+        ladderFilter.dsp.setMode( static_cast<juce::dsp::LadderFilterMode>(ladderFilterMode->getIndex()));
+       #if JUCE_USE_SIMD
+        auto filterModulated = modulation.isModulating(ladderFilterCutoffHz) || modulation.isModulating(ladderFilterResonance);
+        ladderFilter.dsp.setParameterRampLength( filterModulated ? static_cast<float>(getModulationIntervalSeconds()) : SIMDLadderFilter::defaultRampLengthSeconds );
+       #endif
+        ladderFilter.dsp.setCutoffFrequencyHz( getModulatedValue(ladderFilterCutoffHz) );
+        ladderFilter.dsp.setResonance( getModulatedValue(ladderFilterResonance) );
+        ladderFilter.dsp.setDrive( getModulatedValue(ladderFilterDrive) );
+        ladderFilter.setMix( getModulatedValue(ladderFilterMixPercent) );
+        
+        //a lowpass wide open, with no resonance and no drive
+        auto mode = static_cast<juce::dsp::LadderFilterMode>(ladderFilterMode->getIndex());
+        auto isNeutral = (mode == juce::dsp::LadderFilterMode::LPF12 || mode == juce::dsp::LadderFilterMode::LPF24)
+                            && getModulatedValue(ladderFilterCutoffHz) >= ladderFilterCutoffHz->range.end
+                            && getModulatedValue(ladderFilterResonance) <= 0.f
+                            && getModulatedValue(ladderFilterDrive) <= 1.f;
+        ladderFilter.setBypassed( ladderFilterBypass->get() || isNeutral );
+    }
+    
+    //an oversampling change only takes effect once its fade out is done, in whichever sub-block that is.
+    if( auto latency = getChainLatencySamples(); latency != pendingLatencySamples.load() )
+    {
+        pendingLatencySamples.store(latency);
+        triggerHostUpdate();
+    }
+    
+    if( getParamListener(DSP_Option::GeneralFilter).dirty.exchange(false) )
+    {
+        auto params = getGeneralFilterParams(getSampleRate());
+        
+        generalFilter.setMix( getModulatedValue(generalFilterMixPercent) );
+        
+       #if JUCE_USE_SIMD
+        auto filterModulated = modulation.isModulating(generalFilterFreqHz) || modulation.isModulating(generalFilterQuality) || modulation.isModulating(generalFilterGain);
+        generalFilter.dsp.setCoefficientRampLength( filterModulated ? static_cast<float>(getModulationIntervalSeconds()) : SIMDBiquad::defaultRampLengthSeconds );
+       #endif
+        
+        //offline nothing is waiting on this thread, and the render mustn't depend on when the generator gets round to it.
+        if( isNonRealtime() )
+            FilterCoefficientGenerator::makeCoefficients(params, *generalFilter.dsp.state);
+        //if the fifo is full, try again next block.
+        else if( ! generalFilterParamsFifo.push(params) )
+            getParamListener(DSP_Option::GeneralFilter).dirty.store(true);
+        
+        //a 0dB peak is flat. the other modes always change the phase or the magnitude.
+        auto isNeutral = params.mode == GeneralFilterMode::Peak && params.gain == 0.f;
+        generalFilter.setBypassed( generalFilterBypass->get() || isNeutral );
+    }
+    
+    updateGeneralFilterCoefficients();
+    
+    //updateHostTempo() marks the delay dirty when a synced delay's tempo changes.
+    if( getParamListener(DSP_Option::Delay).dirty.exchange(false) )
+    {
+        delay.dsp.setDelayTimeMs( getDelayTimeMs() );
+        delay.dsp.setFeedback( getModulatedValue(delayFeedbackPercent) );
+        delay.dsp.setMix( getModulatedValue(delayMixPercent) );
+        delay.dsp.setPingPong( delayPingPong->get() );
+        
+        auto isNeutral = getModulatedValue(delayMixPercent) <= delayMixPercent->range.start;
+        delay.setBypassed( delayBypass->get() || isNeutral );
+    }
+}
+
+float Project13AudioProcessor::getDelayTimeMs() const
+{
+    if( delaySync->get() && hostBpm > 0.0 )
+        return static_cast<float>(60000.0 / hostBpm) * getDelayNoteLengthInBeats(delayNote->getIndex());
+    
+    return getModulatedValue(delayTimeMs);
+}
+
+/*
+ the synced delay time follows the host tempo, which can change without any parameter moving.
+ the play head is asked once per host block, and the delay only reconfigured when the tempo moved.
+ */
+void Project13AudioProcessor::updateHostTempo()
+{
+    double bpm = 0.0;
+    if( auto* playHead = getPlayHead() )
+    {
+        if( auto position = playHead->getPosition() )
+        {
+            if( auto positionBpm = position->getBpm(); positionBpm.hasValue() && *positionBpm > 0.0 )
+                bpm = *positionBpm;
+        }
+    }
+    
+    if( bpm == hostBpm )
+        return;
+    
+    hostBpm = bpm;
+    if( delaySync->get() )
+        getParamListener(DSP_Option::Delay).dirty.store(true);
+}
+
+/*
+ bypassed modules keep their latency (see Oversampled::processBypassed), so this only depends on the oversampling settings.
+ */
+int Project13AudioProcessor::getChainLatencySamples() const
+{
+    return overdrive.dsp.getLatencyInSamples() + ladderFilter.dsp.getLatencyInSamples();
+}
+
+size_t Project13AudioProcessor::getOversamplingFactorLog2(const juce::AudioParameterChoice& choice) const
+{
+    if( isNonRealtime() && maxOversamplingWhenNonRealtime.load() )
+        return Oversampled<Waveshaper>::maxFactorLog2;
+    
+    return static_cast<size_t>(choice.getIndex());
+}
+
+void Project13AudioProcessor::setNonRealtime(bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+    
+    //the oversampling follows on the next block. the latency change reaches the host the usual way.
+    getParamListener(DSP_Option::OverDrive).dirty.store(true);
+    getParamListener(DSP_Option::LadderFilter).dirty.store(true);
+}
+
+/*
+ what the plugin wrappers do for host automation, without notifying anyone from the audio thread.
+ call triggerHostUpdate() after, so the host hears about it.
+ */
+void Project13AudioProcessor::setParameterFromAudioThread(int index, float normalisedValue)
+{
+    getParameters()[index]->setValue(normalisedValue);
+    
+    auto modules = parameterModules[static_cast<size_t>(index)];
+    for( size_t i = 0; i < moduleParamListeners.size(); ++i )
+    {
+        if( modules & (1u << i) )
+            moduleParamListeners[i].dirty.store(true);
+    }
+    
+    parametersMovedOnAudioThread[static_cast<size_t>(index)].store(true);
+}
+
+/*
+ sets the parameter mapped to the CC's controller, if there is one.
+ */
+bool Project13AudioProcessor::applyMidiController(const juce::MidiMessage& message)
+{
+    auto index = midiLearn.handleController(message.getControllerNumber());
+    if( ! juce::isPositiveAndBelow(index, getParameters().size()) )
+        return false;
+    
+    setParameterFromAudioThread(index, static_cast<float>(message.getControllerValue()) / 127.f);
+    triggerHostUpdate();
+    
+    return true;
+}
+
+/*
+ called at each sub-block boundary, before the order and the parameters are read.
+ */
+void Project13AudioProcessor::updateSwitches()
+{
+    //a program picked mid fade fades in from wherever this one left off.
+    if( auto index = pendingProgram.exchange(-1); index >= 0 )
+    {
+        fadingToProgram = index;
+        switchFade.setTargetValue(0.f);
+    }
+    
+    //a newer frame replaces one still waiting for the fade.
+    if( snapshotMorpher.frames.pull() )
+        morphFramePending = true;
+    
+    //the modules are shared by every order, so they can't run in the old and new order at once.
+    //an order change fades out, switches and fades back in instead.
+    if( dspOrderPending && switchFade.getTargetValue() == 1.f )
+        switchFade.setTargetValue(0.f);
+    
+    if( morphFramePending && switchFade.getTargetValue() == 1.f )
+    {
+        //only a crossover needs the fade. continuous moves go straight to the DSPs' smoothing.
+        if( morphFrameSwitchesDiscrete(snapshotMorpher.frames.getReadBuffer()) )
+        {
+            switchFade.setTargetValue(0.f);
+        }
+        else
+        {
+            applyMorphFrame(snapshotMorpher.frames.getReadBuffer());
+            morphFramePending = false;
+        }
+    }
+    
+    if( switchFade.getTargetValue() == 0.f && ! switchFade.isSmoothing() )
     {
-        if( dspPointers[i] != nullptr )
+        if( morphFramePending )
+        {
+            applyMorphFrame(snapshotMorpher.frames.getReadBuffer());
+            morphFramePending = false;
+        }
+        
+        if( dspOrderPending )
         {
-            dspPointers[i]->process(context);
+            applyDSPOrder(pendingDSPOrder);
+            dspOrderPending = false;
         }
+        
+        //after the frame and the order, so picking a program always wins.
+        if( fadingToProgram >= 0 )
+        {
+            applyProgram(fadingToProgram);
+            fadingToProgram = -1;
+        }
+        
+        switchFade.setTargetValue(1.f);
+    }
+}
+
+bool Project13AudioProcessor::morphFrameSwitchesDiscrete(const Morpher::Frame& frame) const
+{
+    auto& kinds = snapshotMorpher.getParameterKinds();
+    auto& parameters = getParameters();
+    for( size_t i = 0; i < kinds.size(); ++i )
+    {
+        if( kinds[i] == Morpher::ParameterKind::Discrete && frame.values[i] != parameters[static_cast<int>(i)]->getValue() )
+            return true;
+    }
+    
+    return frame.order != dspOrder;
+}
+
+void Project13AudioProcessor::applyMorphFrame(const Morpher::Frame& frame)
+{
+    auto& kinds = snapshotMorpher.getParameterKinds();
+    auto& parameters = getParameters();
+    for( size_t i = 0; i < kinds.size(); ++i )
+    {
+        const auto index = static_cast<int>(i);
+        if( kinds[i] != Morpher::ParameterKind::Excluded && frame.values[i] != parameters[index]->getValue() )
+            setParameterFromAudioThread(index, frame.values[i]);
+    }
+    
+    applyDSPOrder(frame.order);
+    triggerHostUpdate();
+}
+
+void Project13AudioProcessor::captureSnapshot(int slot)
+{
+    Morpher::Snapshot snapshot;
+    for( auto* parameter : getParameters() )
+        snapshot.values.push_back(parameter->getValue());
+    
+    snapshot.order = getDSPOrder();
+    snapshotMorpher.setSnapshot(slot, std::move(snapshot));
+}
+
+void Project13AudioProcessor::clearSnapshot(int slot)
+{
+    snapshotMorpher.clearSnapshot(slot);
+}
+
+bool Project13AudioProcessor::hasSnapshot(int slot) const
+{
+    return snapshotMorpher.hasSnapshot(slot);
+}
+
+/*
+ the program's row of the table, swapped in without touching the APVTS state tree.
+ the APVTS picks the new values up on its own timer.
+ */
+void Project13AudioProcessor::applyProgram(int index)
+{
+    auto& parameters = getParameters();
+    const auto numParameters = static_cast<size_t>(parameters.size());
+    const auto* values = programs.values.data() + static_cast<size_t>(index) * numParameters;
+    
+    for( int i = 0; i < parameters.size(); ++i )
+    {
+        if( values[i] != parameters[i]->getValue() )
+            setParameterFromAudioThread(i, values[i]);
+    }
+    
+    if( auto& order = programs.orders[static_cast<size_t>(index)] )
+        applyDSPOrder(*order);
+    
+    triggerHostUpdate();
+}
+
+void Project13AudioProcessor::applySwitchFade(juce::dsp::AudioBlock<float>& block)
+{
+    const auto numChannels = block.getNumChannels();
+    for( size_t i = 0; i < block.getNumSamples(); ++i )
+    {
+        auto gain = switchFade.getNextValue();
+        for( size_t ch = 0; ch < numChannels; ++ch )
+            block.getChannelPointer(ch)[i] *= gain;
+    }
+}
+
+/*
+ polled, so the audio thread only ever sets a flag: posting a message would lock and make a system call.
+ */
+void Project13AudioProcessor::timerCallback()
+{
+    if( ! hostUpdatePending.exchange(false) )
+        return;
+    
+    setLatencySamples(pendingLatencySamples.load());
+    
+    //the host, the APVTS and the editor hear about CC moves and program changes from here.
+    auto& parameters = getParameters();
+    for( int i = 0; i < parameters.size(); ++i )
+    {
+        if( parametersMovedOnAudioThread[static_cast<size_t>(i)].exchange(false) )
+            parameters[i]->sendValueChangedMessageToListeners(parameters[i]->getValue());
+    }
+}
+
+GeneralFilterParams Project13AudioProcessor::getGeneralFilterParams(double sampleRate) const
+{
+    GeneralFilterParams params;
+    params.mode = static_cast<GeneralFilterMode>(generalFilterMode->getIndex());
+    params.frequency = getModulatedValue(generalFilterFreqHz);
+    params.quality = getModulatedValue(generalFilterQuality);
+    params.gain = getModulatedValue(generalFilterGain);
+    params.sampleRate = sampleRate;
+    return params;
+}
+
+void Project13AudioProcessor::updateGeneralFilterCoefficients()
+{
+    FilterCoefficientGenerator::Coefficients::Ptr newCoefficients;
+    while( generalFilterCoefficientsFifo.pull(newCoefficients) )
+    {
+        
     }
-   
     
+    //offline the coefficients are made synchronously. anything still coming from the generator is stale.
+    if( newCoefficients == nullptr || isNonRealtime() )
+        return;
+    
+    //copy the values rather than swapping the Ptr.
+    //the filters for each channel share 'state', and copying the Array would allocate.
+    auto& src = newCoefficients->coefficients;
+    auto& dst = generalFilter.dsp.state->coefficients;
+    jassert( src.size() == dst.size() );
+    if( src.size() == dst.size() )
+        std::copy(src.begin(), src.end(), dst.begin());
 }
 
 //==============================================================================
@@ -575,43 +2271,80 @@ bool Project13AudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* Project13AudioProcessor::createEditor()
 {
-//    return new Project13AudioProcessorEditor (*this);
-    return new juce::GenericAudioProcessorEditor(*this);
+    return new Project13AudioProcessorEditor (*this);
 }
 
 //==============================================================================
 
+/*
+ 'saved': the DSP_Options of a saved order, slot by slot.
+ orders saved before an option existed are shorter: the missing options go at the end, in enum order.
+ nothing if 'saved' has options out of range or repeated.
+ */
+template<typename Int>
+std::optional<Project13AudioProcessor::DSP_Order> makeDSPOrder(const Int* saved, size_t numSaved)
+{
+    using DSP_Option = Project13AudioProcessor::DSP_Option;
+    constexpr auto numOptions = static_cast<size_t>(DSP_Option::END_OF_LIST);
+    
+    if( numSaved > numOptions )
+        return {};
+    
+    Project13AudioProcessor::DSP_Order order;
+    std::array<bool, numOptions> used {};
+    
+    for( size_t i = 0; i < numSaved; ++i )
+    {
+        auto option = static_cast<int>(saved[i]);
+        if( ! juce::isPositiveAndBelow(option, static_cast<int>(numOptions)) || used[static_cast<size_t>(option)] )
+            return {};
+        
+        used[static_cast<size_t>(option)] = true;
+        order[i] = static_cast<DSP_Option>(option);
+    }
+    
+    auto slot = numSaved;
+    for( size_t option = 0; option < numOptions; ++option )
+    {
+        if( ! used[option] )
+            order[slot++] = static_cast<DSP_Option>(option);
+    }
+    
+    return order;
+}
+
+/*
+ the order as the ValueTree state stores it: binary data, one little endian int per slot.
+ */
+std::optional<Project13AudioProcessor::DSP_Order> readDSPOrder(const juce::var& v)
+{
+    auto* mb = v.getBinaryData();
+    if( mb == nullptr || mb->getSize() % sizeof(int) != 0 )
+        return {};
+    
+    std::array<int, std::tuple_size_v<Project13AudioProcessor::DSP_Order>> saved {};
+    const auto numSaved = mb->getSize() / sizeof(int);
+    if( numSaved > saved.size() )
+        return {};
+    
+    for( size_t i = 0; i < numSaved; ++i )
+        saved[i] = static_cast<int>(juce::ByteOrder::littleEndianInt(static_cast<const char*>(mb->getData()) + i * sizeof(int)));
+    
+    return makeDSPOrder(saved.data(), numSaved);
+}
+
 template<>
 struct juce::VariantConverter<Project13AudioProcessor::DSP_Order>
 {
     static Project13AudioProcessor::DSP_Order fromVar(const juce::var& v)
     {
-        using T = Project13AudioProcessor::DSP_Order;
-        T dspOrder;
+        if( auto order = readDSPOrder(v) )
+            return *order;
         
-        jassert(v.isBinaryData());
-        if(! v.isBinaryData() )
-        {
-            dspOrder.fill(Project13AudioProcessor::DSP_Option::END_OF_LIST);
-        }
-        else
-        {
-            auto mb = *v.getBinaryData();
-                        
-            juce::MemoryInputStream mis(mb, false);
-            std::vector<int> arr;
-            while(! mis.isExhausted() )
-            {
-                arr.push_back( mis.readInt() );
-            }
-            jassert( arr.size() == dspOrder.size() );
-            for( size_t i = 0; i < dspOrder.size(); ++i )
-            {
-                dspOrder[i] = static_cast<Project13AudioProcessor::DSP_Option>(arr[i]);
-            }
-        }
+        jassertfalse;
+        Project13AudioProcessor::DSP_Order dspOrder;
+        dspOrder.fill(Project13AudioProcessor::DSP_Option::END_OF_LIST);
         return dspOrder;
-        
     }
     
     static juce::var toVar(const Project13AudioProcessor::DSP_Order& t)
@@ -632,13 +2365,92 @@ struct juce::VariantConverter<Project13AudioProcessor::DSP_Order>
 
 
 
+/*
+ without a bank there's one program, with no row in the table: hosts want at least one,
+ and picking it leaves the session alone.
+ */
+void Project13AudioProcessor::loadPrograms(const juce::File& bank)
+{
+    if( bank.existsAsFile() )
+    {
+        PresetBank::load(bank, [this](const juce::String& name, const BinaryState& state)
+        {
+            programs.names.add(name);
+            auto values = getParameterValues(state.parameterValues, getSavedParameterIndices(state));
+            programs.values.insert(programs.values.end(), values.begin(), values.end());
+            programs.orders.push_back(makeDSPOrder(state.dspOrder.data(), state.dspOrder.size()));
+        });
+    }
+    
+    if( programs.names.isEmpty() )
+        programs.names.add("Default");
+}
+
 //==============================================================================
 void Project13AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
+    writeState(destData, StateFormat::Binary);
+}
+
+void Project13AudioProcessor::writeState(juce::MemoryBlock& destData, StateFormat format)
+{
+    if( format == StateFormat::Binary )
+    {
+        BinaryState state;
+        
+        state.parameterIDs = parameterIDHashes;
+        state.parameterValues.reserve(parameterIDHashes.size());
+        for( auto* parameter : getParameters() )
+            state.parameterValues.push_back(parameter->getValue());
+        
+        for( auto option : getDSPOrder() )
+            state.dspOrder.push_back(static_cast<juce::uint8>(option));
+        
+        for( int controller = 0; controller < MidiLearn::numControllers; ++controller )
+        {
+            auto index = midiLearn.getParameterFor(controller);
+            if( index != MidiLearn::notMapped )
+                state.midiMappings.push_back({ static_cast<juce::uint8>(controller), static_cast<juce::uint16>(index) });
+        }
+        
+        for( int slot = 0; slot < Morpher::numSnapshots; ++slot )
+        {
+            if( auto snapshot = snapshotMorpher.getSnapshot(slot) )
+            {
+                BinaryState::Snapshot saved;
+                saved.slot = static_cast<juce::uint8>(slot);
+                saved.parameterValues = snapshot->values;
+                for( auto option : snapshot->order )
+                    saved.dspOrder.push_back(static_cast<juce::uint8>(option));
+                
+                state.snapshots.push_back(std::move(saved));
+            }
+        }
+        
+        state.write(destData);
+        return;
+    }
+    
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
-    apvts.state.setProperty("dspOrder", juce::VariantConverter<Project13AudioProcessor::DSP_Order>::toVar(dspOrder), nullptr);
+    apvts.state.setProperty("dspOrder", juce::VariantConverter<Project13AudioProcessor::DSP_Order>::toVar(getDSPOrder()), nullptr);
+    
+    //MIDI learn: <MidiLearn><Mapping controller="74" parameter="Ladder Filter Cutoff Hz"/></MidiLearn>
+    apvts.state.removeChild(apvts.state.getChildWithName("MidiLearn"), nullptr);
+    juce::ValueTree midiLearnTree("MidiLearn");
+    for( int controller = 0; controller < MidiLearn::numControllers; ++controller )
+    {
+        auto index = midiLearn.getParameterFor(controller);
+        if( auto* parameter = dynamic_cast<juce::AudioProcessorParameterWithID*>(getParameters()[index]) )
+        {
+            juce::ValueTree mapping("Mapping");
+            mapping.setProperty("controller", controller, nullptr);
+            mapping.setProperty("parameter", parameter->paramID, nullptr);
+            midiLearnTree.appendChild(mapping, nullptr);
+        }
+    }
+    apvts.state.appendChild(midiLearnTree, nullptr);
     
     
     juce::MemoryOutputStream mos(destData, false);
@@ -647,18 +2459,143 @@ void Project13AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 
 void Project13AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
+    if( sizeInBytes <= 0 )
+        return;
+    
+    const auto size = static_cast<size_t>(sizeInBytes);
+    if( BinaryState::isBinaryState(data, size) )
+    {
+        BinaryState state;
+        if( state.read(data, size) )
+            applyBinaryState(state);
+        
+        return;
+    }
+    
+    //the ValueTree format older versions wrote.
+    auto tree = juce::ValueTree::readFromData(data, size);
     if ( tree.isValid() )
     {
         apvts.replaceState(tree);
         if( apvts.state.hasProperty("dspOrder"))
         {
-            auto order = juce::VariantConverter<Project13AudioProcessor::DSP_Order>::fromVar(apvts.state.getProperty("dspOrder"));
-            dspOrderFifo.push(order);
+            if( auto order = readDSPOrder(apvts.state.getProperty("dspOrder")) )
+            {
+                dspOrderFifo.push(*order);
+                //saved straight back, before the audio thread has run, the state still has it.
+                publishDSPOrder(*order);
+            }
+        }
+        
+        midiLearn.clearAll();
+        for( auto mapping : apvts.state.getChildWithName("MidiLearn") )
+        {
+            int controller = mapping.getProperty("controller", MidiLearn::notMapped);
+            auto* parameter = apvts.getParameter(mapping.getProperty("parameter").toString());
+            if( parameter != nullptr && juce::isPositiveAndBelow(controller, MidiLearn::numControllers) )
+                midiLearn.setMapping(controller, parameter->getParameterIndex());
         }
-        DBG( apvts.state.toXmlString() );
+    }
+}
+
+/*
+ for each parameter in the saved state, its index in getParameters(), or -1 if it no longer exists.
+ version 1 states have no ID table and were saved in getParameters() order.
+ */
+std::vector<int> Project13AudioProcessor::getSavedParameterIndices(const BinaryState& state) const
+{
+    const auto numParameters = static_cast<int>(parameterIDHashes.size());
+    std::vector<int> indices;
+    
+    if( state.parameterIDs.empty() )
+    {
+        for( size_t i = 0; i < state.parameterValues.size(); ++i )
+            indices.push_back(static_cast<int>(i) < numParameters ? static_cast<int>(i) : -1);
+        
+        return indices;
+    }
+    
+    for( auto id : state.parameterIDs )
+    {
+        auto it = std::find(parameterIDHashes.begin(), parameterIDHashes.end(), id);
+        indices.push_back(it != parameterIDHashes.end() ? static_cast<int>(std::distance(parameterIDHashes.begin(), it)) : -1);
+    }
+    
+    return indices;
+}
+
+/*
+ the saved values laid out in getParameters() order.
+ parameters the state doesn't have go back to their defaults, as they do with replaceState().
+ */
+std::vector<float> Project13AudioProcessor::getParameterValues(const std::vector<float>& saved, const std::vector<int>& savedToCurrent) const
+{
+    auto& parameters = getParameters();
+    std::vector<float> values;
+    values.reserve(static_cast<size_t>(parameters.size()));
+    for( auto* parameter : parameters )
+        values.push_back(parameter->getDefaultValue());
+    
+    for( size_t i = 0; i < saved.size() && i < savedToCurrent.size(); ++i )
+    {
+        if( savedToCurrent[i] >= 0 )
+            values[static_cast<size_t>(savedToCurrent[i])] = juce::jlimit(0.f, 1.f, saved[i]);
+    }
+    
+    return values;
+}
+
+/*
+ sets the parameters directly instead of rebuilding the APVTS state.
+ */
+void Project13AudioProcessor::applyBinaryState(const BinaryState& state)
+{
+    //the parameters were saved where the morph left them, don't morph again to the restored position.
+    const Morpher::ScopedRestore restore(snapshotMorpher);
+    
+    auto& parameters = getParameters();
+    const auto savedToCurrent = getSavedParameterIndices(state);
+    
+    auto values = getParameterValues(state.parameterValues, savedToCurrent);
+    for( int i = 0; i < parameters.size(); ++i )
+    {
+        auto* parameter = parameters[i];
+        auto value = values[static_cast<size_t>(i)];
+        if( value != parameter->getValue() )
+            parameter->setValueNotifyingHost(value);
+    }
+    
+    if( auto order = makeDSPOrder(state.dspOrder.data(), state.dspOrder.size()) )
+    {
+        dspOrderFifo.push(*order);
+        //saved straight back, before the audio thread has run, the state still has it.
+        publishDSPOrder(*order);
+    }
+    
+    midiLearn.clearAll();
+    for( auto& mapping : state.midiMappings )
+    {
+        if( ! juce::isPositiveAndBelow(static_cast<int>(mapping.controller), MidiLearn::numControllers) || mapping.parameterIndex >= savedToCurrent.size() )
+            continue;
+        
+        if( auto index = savedToCurrent[mapping.parameterIndex]; index >= 0 )
+            midiLearn.setMapping(mapping.controller, index);
+    }
+    
+    for( int slot = 0; slot < Morpher::numSnapshots; ++slot )
+        snapshotMorpher.clearSnapshot(slot);
+    
+    for( auto& saved : state.snapshots )
+    {
+        auto order = makeDSPOrder(saved.dspOrder.data(), saved.dspOrder.size());
+        if( saved.slot >= Morpher::numSnapshots || ! order )
+            continue;
+        
+        Morpher::Snapshot snapshot;
+        snapshot.order = *order;
+        snapshot.values = getParameterValues(saved.parameterValues, savedToCurrent);
+        
+        snapshotMorpher.setSnapshot(saved.slot, std::move(snapshot));
     }
 }
 
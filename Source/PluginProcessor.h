@@ -10,22 +10,32 @@
 
 #include <JuceHeader.h>
 #include "../SimpleMultiBandComp/Source/DSP/Fifo.h"
+#include "DSP/ChannelCount.h"
+#include "DSP/GeneralFilterCoefficients.h"
+#include "DSP/Oversampled.h"
+#include "DSP/Waveshaper.h"
+#include "DSP/BlockDelay.h"
+#include "DSP/StageMeters.h"
+#include "DSP/SpectrumAnalyser.h"
+#include "DSP/DryWetBlend.h"
+#include "DSP/SIMDFilters.h"
+#include "DSP/Modulation.h"
+#include "DSP/SubBlockScheduler.h"
+#include "DSP/MidiLearn.h"
+#include "DSP/BinaryState.h"
+#include "DSP/PresetBank.h"
+#include "DSP/SnapshotMorph.h"
+#include "DSP/RealtimeCheck.h"
+#include "DSP/StageProfiler.h"
+#include "DSP/TailSleep.h"
 
 //TODO: add APVTS
 //TODO: create audio parameters for all dsp choices
 //TODO: update DSP here from audio parameters
-//TODO: save/load settings
-//TODO: save/load DSP order
 //TODO: Drag-To-Reorder GUI
 //TODO: GUI design for each DSP instance?
-//TODO: metering
 //TODO: prepare all DSP
-//TODO: wet/dry knob [BONUS]
-//TODO: mono & stereo versions [mono is BONUS]
-//TODO: modulators [BONUS]
-//TODO: thread-safe filter updating [BONUS]
 //TODO: pre/post filtering [BONUS]
-//TODO: delay module [BONUS]
 
 
 //==============================================================================
@@ -35,10 +45,12 @@ class Project13AudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::Timer
 {
 public:
     //==============================================================================
-    Project13AudioProcessor();
+    //the programs are read from 'presetBank', see PresetBank.h.
+    explicit Project13AudioProcessor(const juce::File& presetBank = getPresetBankFile());
     ~Project13AudioProcessor() override;
 
     //==============================================================================
@@ -50,6 +62,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    
+    void setNonRealtime (bool isNonRealtime) noexcept override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -74,6 +88,28 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
+    /*
+     Binary: see BinaryState.h. what getStateInformation() writes.
+     ValueTree: the APVTS state with the order as a property, what older versions wrote.
+     setStateInformation() reads both.
+     */
+    enum class StateFormat
+    {
+        Binary,
+        ValueTree,
+    };
+    
+    void writeState(juce::MemoryBlock& destData, StateFormat format);
+    
+    //the bank the programs come from, see PresetBank.h. read once, in the constructor.
+    static juce::File getPresetBankFile();
+    
+    /*
+     the current state into 'bank' as 'name', replacing a preset of that name. message thread only.
+     the programs are read once, so a new preset shows up in the next instance.
+     */
+    bool savePreset(const juce::String& name, const juce::File& bank = getPresetBankFile());
+    
     enum class DSP_Option
     {
         Phase,
@@ -81,6 +117,7 @@ public:
         OverDrive,
         LadderFilter,
         GeneralFilter,
+        Delay,
         END_OF_LIST
     };
     
@@ -88,8 +125,47 @@ public:
     
     using DSP_Pointers = std::array<juce::dsp::ProcessorBase*, static_cast<size_t>(DSP_Option::END_OF_LIST)>;
     
+    static const char* getModuleName(DSP_Option option);
+    
     SimpleMBComp::Fifo<DSP_Order> dspOrderFifo;
     
+    //fade out and back in around an order change, instead of jumping.
+    std::atomic<bool> crossfadeOrderChanges { true };
+    //process each slot through a per-module function instead of a virtual call on DSP_Pointers.
+    std::atomic<bool> useStaticDispatch { true };
+    //skip the chain while the input is silent and the tails have decayed, see SilenceDetector.
+    std::atomic<bool> sleepWhenSilent { true };
+    //non-realtime renders run the oversampled modules at the highest factor. off: at the parameters' factors.
+    std::atomic<bool> maxOversamplingWhenNonRealtime { true };
+    
+    static constexpr int defaultSubBlockSize = 32;
+    //the chain runs in sub-blocks of at most this many samples, see SubBlockScheduler. read in prepareToPlay().
+    std::atomic<int> subBlockSize { defaultSubBlockSize };
+    
+    //input, after each DSP_Order slot, output
+    static constexpr size_t numMeterPoints = static_cast<size_t>(DSP_Option::END_OF_LIST) + 2;
+    static constexpr size_t inputMeterPoint = 0;
+    static constexpr size_t outputMeterPoint = numMeterPoints - 1;
+    static constexpr size_t getSlotMeterPoint(size_t slot) { return slot + 1; }
+    
+    using Meters = StageMeters<numMeterPoints>;
+    //measured on the audio thread, pulled by the editor.
+    Meters stageMeters;
+    
+    //one stage per DSP_Option, timed on the audio thread while it has viewers.
+    using Profiler = StageProfiler<static_cast<size_t>(DSP_Option::END_OF_LIST)>;
+    Profiler stageProfiler;
+    
+    //fed on the audio thread while the analyser thread has viewers.
+    SpectrumAnalyser preChainSpectrum, postChainSpectrum;
+    SpectrumAnalyserThread spectrumAnalyserThread { preChainSpectrum, postChainSpectrum };
+    
+    //CC -> parameter mappings. set from the editor, applied in processBlock.
+    MidiLearn midiLearn;
+    
+    //CCs less than this far apart share a split of the block, see processBlock().
+    static constexpr size_t ccCoalesceSamples = 16;
+    
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Settings", createParameterLayout()};
     
@@ -106,20 +182,132 @@ public:
     juce::AudioParameterFloat* chorusMixPercent = nullptr;
     
     juce::AudioParameterFloat* overdriveSaturation = nullptr;
+    juce::AudioParameterChoice* overdriveCurve = nullptr;
+    juce::AudioParameterFloat* overdriveMixPercent = nullptr;
     
     juce::AudioParameterChoice* ladderFilterMode = nullptr;
     juce::AudioParameterFloat* ladderFilterCutoffHz = nullptr;
     juce::AudioParameterFloat* ladderFilterResonance = nullptr;
     juce::AudioParameterFloat* ladderFilterDrive = nullptr;
+    juce::AudioParameterFloat* ladderFilterMixPercent = nullptr;
     
     juce::AudioParameterChoice* generalFilterMode = nullptr;
     juce::AudioParameterFloat* generalFilterFreqHz = nullptr;
     juce::AudioParameterFloat* generalFilterQuality = nullptr;
     juce::AudioParameterFloat* generalFilterGain = nullptr;
+    juce::AudioParameterFloat* generalFilterMixPercent = nullptr;
+    
+    juce::AudioParameterFloat* delayTimeMs = nullptr;
+    juce::AudioParameterBool* delaySync = nullptr;
+    juce::AudioParameterChoice* delayNote = nullptr;
+    juce::AudioParameterFloat* delayFeedbackPercent = nullptr;
+    juce::AudioParameterFloat* delayMixPercent = nullptr;
+    juce::AudioParameterBool* delayPingPong = nullptr;
+    
+    juce::AudioParameterBool* phaserBypass = nullptr;
+    juce::AudioParameterBool* chorusBypass = nullptr;
+    juce::AudioParameterBool* overdriveBypass = nullptr;
+    juce::AudioParameterBool* ladderFilterBypass = nullptr;
+    juce::AudioParameterBool* generalFilterBypass = nullptr;
+    juce::AudioParameterBool* delayBypass = nullptr;
+    
+    juce::AudioParameterFloat* globalMixPercent = nullptr;
+    
+    juce::AudioParameterChoice* overdriveOversampling = nullptr;
+    juce::AudioParameterChoice* ladderFilterOversampling = nullptr;
+    juce::AudioParameterChoice* oversamplingFilter = nullptr;
+    
+    std::array<juce::AudioParameterFloat*, 2> lfoRateHz {};
+    std::array<juce::AudioParameterChoice*, 2> lfoShape {};
+    juce::AudioParameterFloat* envelopeAttackMs = nullptr;
+    juce::AudioParameterFloat* envelopeReleaseMs = nullptr;
+    juce::AudioParameterFloat* stepSequencerRateHz = nullptr;
+    std::array<juce::AudioParameterFloat*, StepSequencer::numSteps> stepSequencerSteps {};
+    
+    std::array<juce::AudioParameterChoice*, ModulationMatrix::numSlots> modSlotSource {};
+    std::array<juce::AudioParameterChoice*, ModulationMatrix::numSlots> modSlotTarget {};
+    std::array<juce::AudioParameterFloat*, ModulationMatrix::numSlots> modSlotDepth {};
+    juce::AudioParameterChoice* modulationInterval = nullptr;
+    
+    //modulationInterval's choices: 8, 16, 32, 64 and 128 samples.
+    static constexpr int getModulationIntervalSamples(int index) { return 8 << index; }
+    
+    juce::AudioParameterFloat* morphPosition = nullptr;
+    
+    using Morpher = SnapshotMorpher<DSP_Order>;
+    
+    //message thread. a snapshot is every parameter but the morph position, and the order, as they are now.
+    void captureSnapshot(int slot);
+    void clearSnapshot(int slot);
+    bool hasSnapshot(int slot) const;
+    
+    //the order the audio thread is running, or the one a restored state asked for. any thread.
+    DSP_Order getDSPOrder() const;
 
 private:
     
+    //audio thread only. everywhere else reads publishedDSPOrder through getDSPOrder().
     DSP_Order dspOrder;
+    //dspOrder packed 4 bits a slot, slot 0 lowest.
+    std::atomic<juce::uint32> publishedDSPOrder { 0 };
+    void publishDSPOrder(const DSP_Order& order);
+    
+    using StageFunction = void (*)(Project13AudioProcessor&, const juce::dsp::ProcessContextReplacing<float>&, size_t slot);
+    
+    /*
+     order: what the chain was built from.
+     pointers: the generic path, one virtual call per slot.
+     stages: each slot's module and metering instantiated for chainNumChannels, so the module's
+     DSP is inlined into it. one indirect call per slot, from a table of one function per
+     DSP_Option and channel count. empty when a slot is empty or the channel count isn't
+     mono or stereo.
+     */
+    struct DSP_Chain
+    {
+        DSP_Order order {};
+        DSP_Pointers pointers;
+        std::array<StageFunction, static_cast<size_t>(DSP_Option::END_OF_LIST)> stages {};
+        bool hasStages = false;
+    };
+    
+    DSP_Chain dspChain;
+    //the channel count the stage functions are picked for. set in prepareToPlay().
+    size_t chainNumChannels = 2;
+    
+    /*
+     an order pulled from dspOrderFifo waits here for switchFade to fade the output out,
+     like a program change. the modules are shared by every order, so the old and new
+     orders can't both run for a crossfade.
+     */
+    DSP_Order pendingDSPOrder {};
+    bool dspOrderPending = false;
+    
+    SubBlockScheduler subBlockScheduler;
+    
+    DSP_Pointers getDSPPointers(const DSP_Order& order);
+    DSP_Chain makeDSPChain(const DSP_Order& order);
+    int beginSubBlock();
+    void processSubBlock(juce::dsp::AudioBlock<float>& block);
+    void processChain(juce::dsp::AudioBlock<float>& block, const DSP_Chain& chain);
+    void updateDSPOrder();
+    void applyDSPOrder(const DSP_Order& newDSPOrder);
+    
+    SilenceDetector silenceDetector;
+    bool shouldSleep(const juce::dsp::AudioBlock<float>& block);
+    bool isSwitching() const;
+    void processAsleep(juce::dsp::AudioBlock<float>& block, const juce::MidiBuffer& midiMessages);
+    ModuleTail getModuleTail(DSP_Option option) const;
+    std::array<ModuleTail, static_cast<size_t>(DSP_Option::END_OF_LIST)> getSlotTails(const DSP_Order& order) const;
+    
+    //the chain's tail and gain, worked out by updateTail() on the audio thread. getTailLengthSeconds() reads the tail from any thread.
+    std::atomic<double> chainTailSeconds { 0.0 };
+    void updateTail();
+    
+    template<DSP_Option Option, size_t NumChannels>
+    void processStage(const juce::dsp::ProcessContextReplacing<float>& context);
+    template<DSP_Option Option, size_t NumChannels>
+    static void processStaticStage(Project13AudioProcessor& processor, const juce::dsp::ProcessContextReplacing<float>& context, size_t slot);
+    static StageFunction getStageFunction(DSP_Option option, size_t numChannels);
     
     template<typename DSP>
     struct DSP_Choice : juce::dsp::ProcessorBase
@@ -127,24 +315,272 @@ private:
         void prepare(const juce::dsp::ProcessSpec& spec) override
         {
             dsp.prepare(spec);
+            blend.prepare(spec.sampleRate, static_cast<int>(spec.maximumBlockSize));
+            dryBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
         }
         void process (const juce::dsp::ProcessContextReplacing<float>& context) override
         {
-            dsp.process(context);
+            processDirect(context);
         }
         void reset() override
         {
             dsp.reset();
         }
         
+        /*
+         bypassed modules are skipped entirely.
+         switching in or out ramps between the dry input and the processed output.
+         */
+        void setBypassed(bool shouldBeBypassed)
+        {
+            bypassed = shouldBeBypassed;
+            updateWetGain();
+        }
+        
+        /*
+         0 - 1, the output is the dry input blended with the processed signal.
+         */
+        void setMix(float newMix)
+        {
+            mix = juce::jlimit(0.f, 1.f, newMix);
+            updateWetGain();
+        }
+        
+        bool isBypassed() const { return blend.getTargetWetGain() == 0.f && ! blend.isSmoothing(); }
+        
+        /*
+         non-virtual, so the statically dispatched chain can inline it.
+         NumChannels: see ChannelCount.h
+         */
+        template<size_t NumChannels = dynamicChannels>
+        void processDirect(const juce::dsp::ProcessContextReplacing<float>& context)
+        {
+            if( ! blend.isSmoothing() )
+            {
+                auto wetGain = blend.getTargetWetGain();
+                if( wetGain == 0.f )
+                {
+                    processBypassed(context);
+                    return;
+                }
+                
+                if( wetGain == 1.f )
+                {
+                    processDSP<NumChannels>(context);
+                    return;
+                }
+            }
+            
+            auto& block = context.getOutputBlock();
+            const auto numSamples = block.getNumSamples();
+            const auto numChannels = juce::jmin(getNumChannels<NumChannels>(block), static_cast<size_t>(dryBuffer.getNumChannels()));
+            
+            //can't ramp without reallocating. finish the ramp instead.
+            if( numSamples > static_cast<size_t>(dryBuffer.getNumSamples()) || ! blend.canProcess(numSamples) )
+            {
+                blend.finishRamp();
+                processDirect<NumChannels>(context);
+                return;
+            }
+            
+            //the dry path goes through processBypassed() so it lines up with the latency of the wet one.
+            auto dry = juce::dsp::AudioBlock<float>(dryBuffer).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+            dry.copyFrom(block);
+            auto dryContext = juce::dsp::ProcessContextReplacing<float>(dry);
+            
+            //DSPs whose bypass path has state of their own do both at once, so that state only moves once.
+            if constexpr ( requires { dsp.template processWithDry<NumChannels>(context, dryContext); } )
+            {
+                dsp.template processWithDry<NumChannels>(context, dryContext);
+            }
+            else
+            {
+                processBypassed(dryContext);
+                processDSP<NumChannels>(context);
+            }
+            
+            blend.process<NumChannels>(block, dry);
+        }
+        
         DSP dsp;
+    private:
+        //our own DSPs have a fixed channel count version of process(). the juce ones only have the generic one.
+        template<size_t NumChannels>
+        void processDSP(const juce::dsp::ProcessContextReplacing<float>& context)
+        {
+            if constexpr ( NumChannels != dynamicChannels && requires { dsp.template process<NumChannels>(context); } )
+                dsp.template process<NumChannels>(context);
+            else
+                dsp.process(context);
+        }
+        
+        //DSPs with latency delay the signal by the same amount when bypassed.
+        void processBypassed(const juce::dsp::ProcessContextReplacing<float>& context)
+        {
+            if constexpr ( requires { dsp.processBypassed(context); } )
+                dsp.processBypassed(context);
+        }
+        
+        void updateWetGain()
+        {
+            auto target = bypassed ? 0.f : mix;
+            if( target == blend.getTargetWetGain() )
+                return;
+            
+            //the dsp hasn't seen any audio while bypassed, don't play back its stale state.
+            if( target > 0.f && blend.getCurrentWetGain() == 0.f )
+                dsp.reset();
+            
+            blend.setWetGain(target);
+        }
+        
+        bool bypassed = false;
+        float mix = 1.f;
+        DryWetBlend blend;
+        juce::AudioBuffer<float> dryBuffer;
     };
     
-    DSP_Choice<juce::dsp::DelayLine<float>> delay;
+    DSP_Choice<BlockDelay> delay;
     DSP_Choice<juce::dsp::Phaser<float>> phaser;
     DSP_Choice<juce::dsp::Chorus<float>> chorus;
-    DSP_Choice<juce::dsp::LadderFilter<float>> overdrive, ladderFilter;
-    DSP_Choice<juce::dsp::IIR::Filter<float>> generalFilter;
+    DSP_Choice<Oversampled<Waveshaper>> overdrive;
+    DSP_Choice<Oversampled<SIMDLadderFilter>> ladderFilter;
+    DSP_Choice<SIMDBiquad> generalFilter;
+    
+    SimpleMBComp::Fifo<GeneralFilterParams> generalFilterParamsFifo;
+    SimpleMBComp::Fifo<FilterCoefficientGenerator::Coefficients::Ptr> generalFilterCoefficientsFifo;
+    FilterCoefficientGenerator generalFilterCoefficientGenerator { generalFilterParamsFifo, generalFilterCoefficientsFifo };
+    
+    GeneralFilterParams getGeneralFilterParams(double sampleRate) const;
+    void updateGeneralFilterCoefficients();
+    
+    float getDelayTimeMs() const;
+    
+    //the host's tempo, read once per host block by updateHostTempo(). 0 when the host doesn't say.
+    double hostBpm = 0.0;
+    void updateHostTempo();
+    
+    /*
+     Flags a module as needing its DSP reconfigured.
+     Registered with the APVTS for only that module's parameters, so processBlock
+     only calls the setters of modules whose parameters actually moved.
+     */
+    struct ModuleParamListener : juce::AudioProcessorValueTreeState::Listener
+    {
+        void parameterChanged(const juce::String&, float) override
+        {
+            dirty.store(true);
+        }
+        
+        std::atomic<bool> dirty { true };
+    };
+    
+    std::array<ModuleParamListener, static_cast<size_t>(DSP_Option::END_OF_LIST)> moduleParamListeners;
+    
+    ModuleParamListener& getParamListener(DSP_Option option) { return moduleParamListeners[static_cast<size_t>(option)]; }
+    void markAllModulesDirty();
+    
+    //bit per DSP_Option, for every parameter in getParameters(): the modules it configures.
+    std::vector<juce::uint32> parameterModules;
+    //parameters moved on the audio thread, by a CC or a program change. the host is told from the message thread.
+    std::vector<std::atomic<bool>> parametersMovedOnAudioThread;
+    //BinaryState::hashParameterID() of every parameter in getParameters(): how saved states find them.
+    std::vector<juce::uint32> parameterIDHashes;
+    
+    void setParameterFromAudioThread(int index, float normalisedValue);
+    bool applyMidiController(const juce::MidiMessage& message);
+    
+    /*
+     The programs, parsed from the preset bank into one flat table: every parameter's
+     normalised value, program after program. Filled in the constructor and never touched
+     again, so the audio thread reads it without locking. without a bank, 'values' is
+     empty and the one name is a placeholder.
+     */
+    struct ProgramTable
+    {
+        juce::StringArray names;
+        std::vector<float> values;
+        std::vector<std::optional<DSP_Order>> orders;
+    };
+    
+    ProgramTable programs;
+    void loadPrograms(const juce::File& bank);
+    
+    /*
+     setCurrentProgram() only publishes the index. at a sub-block boundary the audio thread
+     fades the output out, sets every parameter from the program's row in one go, and fades
+     back in, so choices, oversampling and the order switch without clicks too.
+     */
+    std::atomic<int> currentProgram { 0 };
+    std::atomic<int> pendingProgram { -1 };
+    int fadingToProgram = -1;
+    
+    void applyProgram(int index);
+    
+    /*
+     morph frames are interpolated on the morpher's thread and pulled here at sub-block
+     boundaries. a frame that flips a choice or toggle waits for the same fade as a program change.
+     */
+    Morpher snapshotMorpher;
+    bool morphFramePending = false;
+    
+    bool morphFrameSwitchesDiscrete(const Morpher::Frame& frame) const;
+    void applyMorphFrame(const Morpher::Frame& frame);
+    
+    //the output's fade out and back in around program changes, morph crossovers and order changes.
+    juce::SmoothedValue<float> switchFade { 1.f };
+    
+    void updateSwitches();
+    void applySwitchFade(juce::dsp::AudioBlock<float>& block);
+    
+    void applyBinaryState(const BinaryState& state);
+    std::vector<int> getSavedParameterIndices(const BinaryState& state) const;
+    std::vector<float> getParameterValues(const std::vector<float>& saved, const std::vector<int>& savedToCurrent) const;
+    void updateDSPFromParams();
+    
+    /*
+     Modulation is evaluated once per control interval (modulationInterval), at the start of a sub-block. updateDSPFromParams()
+     reads every float parameter through getModulatedValue(), and the DSPs' parameter smoothing
+     interpolates between the control values.
+     */
+    ModulationMatrix modulation;
+    //the Mod Slot Target choices, and the module each one configures. END_OF_LIST for the global mix.
+    std::vector<juce::AudioParameterFloat*> modulationTargets;
+    std::vector<DSP_Option> modulationTargetModules;
+    //the modules modulated in the last interval.
+    std::array<bool, static_cast<size_t>(DSP_Option::END_OF_LIST)> modulatedModules {};
+    
+    bool isModulationInUse() const;
+    int getModulationIntervalSamples() const;
+    double getModulationIntervalSeconds() const;
+    void updateModulation(int numSamples);
+    int samplesUntilModulation = 0;
+    float getModulatedValue(const juce::AudioParameterFloat* parameter) const { return modulation.getModulatedValue(parameter); }
+    
+    /*
+     global wet/dry: the input is held back by the chain's latency before it's blended
+     with the chain's output.
+     */
+    DryWetBlend globalMix;
+    juce::AudioBuffer<float> globalDryBuffer;
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> globalDryDelay;
+    int globalDryDelaySamples = 0;
+    
+    void pushGlobalDry(const juce::dsp::AudioBlock<float>& block);
+    void mixGlobalDry(juce::dsp::AudioBlock<float>& block);
+    
+    int getChainLatencySamples() const;
+    /*
+     the parameter's factor, or the maximum while rendering offline: there's no deadline,
+     so offline renders always get the least aliasing.
+     */
+    size_t getOversamplingFactorLog2(const juce::AudioParameterChoice& choice) const;
+    //latency changes on the audio thread are reported to the host from the message thread.
+    std::atomic<int> pendingLatencySamples { 0 };
+    
+    std::atomic<bool> hostUpdatePending { false };
+    void triggerHostUpdate() { hostUpdatePending.store(true); }
+    void timerCallback() override;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Project13AudioProcessor)
 };